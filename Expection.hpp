@@ -3,139 +3,745 @@
 #define EXPECTION_HPP
 
 #include <concepts>
+#include <cstddef>
+#include <exception>
 #include <expected>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
-#include <variant>
+#include <vector>
+
+#include "Expection/core.hpp"
 
 namespace Expection {
 
-enum class Policy { Exceptions, Expected };
+// === Error Lists ===
 
-#ifndef EXPECTION_DEFAULTPOLICY
-#define EXPECTION_DEFAULTPOLICY Exceptions
-#endif
+// Errors collected under Policy::Accumulate: while alive, it receives every
+// failure with Error type E made on its thread (lists nest, the innermost one
+// wins). Allocates nothing until the first error, the first Inline errors are
+// stored inside the list, and later ones in memory from `upstream` (e.g. a
+// request-scoped std::pmr::monotonic_buffer_resource)
+template <typename E, std::size_t Inline> class ErrorList {
+public:
+  explicit ErrorList(
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : arena_(buffer_, sizeof(buffer_), upstream), errors_(&arena_),
+        previous_list_(detail::ActiveErrors<E>::list),
+        previous_append_(detail::ActiveErrors<E>::append) {
+    detail::ActiveErrors<E>::list = this;
+    detail::ActiveErrors<E>::append = [](void *list, E &&error) {
+      static_cast<ErrorList *>(list)->append(std::move(error));
+    };
+  }
+
+  // Registered by address for its thread
+  ErrorList(const ErrorList &) = delete;
+  ErrorList &operator=(const ErrorList &) = delete;
+
+  ~ErrorList() {
+    detail::ActiveErrors<E>::list = previous_list_;
+    detail::ActiveErrors<E>::append = previous_append_;
+  }
+
+  void append(E error) {
+    if (errors_.capacity() == 0) {
+      errors_.reserve(Inline);
+    }
+    errors_.push_back(std::move(error));
+  }
+
+  auto empty() const -> bool { return errors_.empty(); }
+  auto size() const -> std::size_t { return errors_.size(); }
+  auto operator[](std::size_t i) const -> const E & { return errors_[i]; }
+  auto begin() const { return errors_.begin(); }
+  auto end() const { return errors_.end(); }
 
-inline constexpr Policy DefaultPolicy = Policy::EXPECTION_DEFAULTPOLICY;
+private:
+  alignas(E) std::byte buffer_[Inline * sizeof(E)];
+  std::pmr::monotonic_buffer_resource arena_;
+  std::pmr::vector<E> errors_;
+  void *previous_list_;
+  void (*previous_append_)(void *, E &&);
+};
+
+// === Allocator-aware Errors ===
+// Errors carrying allocating context (paths, record IDs) are built through
+// uses-allocator construction, e.g. with a std::pmr::polymorphic_allocator over
+// a request-scoped arena, so that failures don't touch the heap. Exceptions are
+// built as with make_failure, since they can outlive the arena
 
-// Meta-function to determine the Return Type
-template <typename R, typename E = std::monostate, Policy P = DefaultPolicy>
-using ResultType =
-    std::conditional_t<P == Policy::Exceptions, R, std::expected<R, E>>;
+namespace detail {
+template <typename Error, typename Alloc, typename... Args>
+concept AllocFailure =
+    requires(const Alloc &alloc, Args &&...args) {
+      std::make_obj_using_allocator<Error>(alloc, std::forward<Args>(args)...);
+    } && (ExceptionPreallocated<Error, Args...> ||
+          ExceptionConstructable<Error, Args...> ||
+          ExceptionConvertible<Error &>);
+} // namespace detail
 
-// === Success Helpers ===
-template <typename R, typename E = std::monostate, Policy P = DefaultPolicy>
-constexpr auto success(R val) -> ResultType<R, E, P> {
+// Constructs Error from args... with the allocator (when Error uses one).
+// `where` is the failure site reported to sampling and profiles
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Alloc, typename... Args>
+  requires detail::AllocFailure<Error, Alloc, Args...>
+constexpr auto make_failure_alloc_at(const std::source_location &where,
+                                     const Alloc &alloc, Args &&...args)
+    -> ResultType<Result, Error, P> {
+  detail::on_failure<Error, P>(where, args...);
+  auto make_error = [&] {
+    return std::make_obj_using_allocator<Error>(alloc,
+                                                std::forward<Args>(args)...);
+  };
 
   if constexpr (P == Policy::Exceptions) {
-    // Return by value, allowing move-construction from the forward
-    return val;
+    if constexpr (ExceptionPreallocated<Error, Args...>) {
+      detail::rethrow_cold(Error::exception_ptr(std::forward<Args>(args)...));
+    } else if constexpr (ExceptionConstructable<Error, Args...>) {
+      detail::raise_cold(detail::StaticException<Error>{},
+                         std::forward<Args>(args)...);
+    } else {
+      auto error = make_error();
+      detail::raise_cold(detail::ConvertedException{}, error);
+    }
+  } else if constexpr (ReturnsExpected<P>) {
+    // Moving keeps the allocator, so the error's storage is never copied
+    return std::unexpected<Error>(make_error());
+  } else if constexpr (P == Policy::Accumulate) {
+    return detail::accumulate<Result>(make_error());
   } else {
-    // Wrap the value in std::expected
-    return std::expected<R, E>(val);
+    detail::abandon<P>();
   }
 }
 
-// Void specialization
-template <typename E = std::monostate, Policy P = DefaultPolicy>
-constexpr auto success() -> ResultType<void, E, P> {
+// As with make_failure(), overloaded for up to three arguments defaulting
+// `where` to the caller. Calls with more arguments are unlocated
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Alloc>
+  requires detail::AllocFailure<Error, Alloc>
+constexpr auto make_failure_alloc(const Alloc &alloc,
+                                  const std::source_location &where =
+                                      std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_alloc_at<Result, Error, P>(where, alloc);
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Alloc, typename A>
+  requires detail::AllocFailure<Error, Alloc, A>
+constexpr auto make_failure_alloc(const Alloc &alloc, A &&a,
+                                  const std::source_location &where =
+                                      std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_alloc_at<Result, Error, P>(where, alloc,
+                                                 std::forward<A>(a));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Alloc, typename A1, typename A2>
+  requires detail::AllocFailure<Error, Alloc, A1, A2>
+constexpr auto make_failure_alloc(const Alloc &alloc, A1 &&a1, A2 &&a2,
+                                  const std::source_location &where =
+                                      std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_alloc_at<Result, Error, P>(
+      where, alloc, std::forward<A1>(a1), std::forward<A2>(a2));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Alloc, typename A1, typename A2, typename A3>
+  requires detail::AllocFailure<Error, Alloc, A1, A2, A3>
+constexpr auto make_failure_alloc(const Alloc &alloc, A1 &&a1, A2 &&a2, A3 &&a3,
+                                  const std::source_location &where =
+                                      std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_alloc_at<Result, Error, P>(
+      where, alloc, std::forward<A1>(a1), std::forward<A2>(a2),
+      std::forward<A3>(a3));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Alloc, typename... Args>
+  requires(sizeof...(Args) > 3) && detail::AllocFailure<Error, Alloc, Args...>
+constexpr auto make_failure_alloc(const Alloc &alloc, Args &&...args)
+    -> ResultType<Result, Error, P> {
+  return make_failure_alloc_at<Result, Error, P>(
+      std::source_location{}, alloc, std::forward<Args>(args)...);
+}
+
+// failure() copying (or moving) the error with the allocator
+template <typename Result, Policy P = DefaultPolicy, typename Alloc,
+          ExceptionConvertible E>
+  requires requires(const Alloc &alloc, E &&error) {
+    std::make_obj_using_allocator<std::decay_t<E>>(alloc,
+                                                   std::forward<E>(error));
+  }
+constexpr auto failure_alloc(const Alloc &alloc, E &&error,
+                             const std::source_location &where =
+                                 std::source_location::current())
+    -> ResultType<Result, std::decay_t<E>, P> {
+  detail::on_failure<std::decay_t<E>, P>(where, error);
   if constexpr (P == Policy::Exceptions) {
-    return;
+    detail::raise_cold(detail::ConvertedException{}, error);
   } else {
-    return std::expected<void, E>{};
+    return detail::convert_failure<Result, P>(
+        std::make_obj_using_allocator<std::decay_t<E>>(
+            alloc, std::forward<E>(error)));
   }
 }
 
-// === Failure Helpers ===
+// === Dynamic Policy Adapter ===
 
-// "Functor" based helpers
-template <typename T, typename Unexpected, typename... Args>
-concept ErrorFunctor = requires(Args &&...args) {
-  {
-    T::exception(std::forward<Args>(args)...)
-  } -> std::derived_from<std::exception>;
+// Converts the result of a function compiled once under Policy::Dynamic to
+// the caller's policy. Errors are converted through error.exception(), or
+// Error::exception(error.kind), when the caller's policy throws. The failure
+// hook isn't called again, it already ran when the error was made
+template <Policy P = DefaultPolicy, typename R, typename E>
+  requires ExceptionConvertible<E> || ExceptionFromKind<E>
+constexpr auto resolve(std::expected<R, E> result) -> ResultType<R, E, P> {
+  if constexpr (std::is_same_v<ResultType<R, E, P>, std::expected<R, E>>) {
+    return result;
+  } else if constexpr (ReturnsExpected<P>) {
+    if (!result.has_value()) [[unlikely]] {
+      return ResultType<R, E, P>(std::unexpect, std::move(result).error());
+    }
+    return ResultType<R, E, P>(std::in_place, *std::move(result));
+  } else {
+    if (!result.has_value()) [[unlikely]] {
+      return detail::convert_failure<R, P>(std::move(result).error());
+    }
+    if constexpr (!std::is_void_v<R>) {
+      return *std::move(result);
+    }
+  }
+}
 
-  {
-    T::unexpected(std::forward<Args>(args)...)
-  } -> std::same_as<std::unexpected<Unexpected>>;
-};
+// === Boundary Adapters ===
+// A component built with Policy::Boundary returns std::expected between its
+// inner layers, where failures are frequent, and converts once at its edge:
+// throw_if_error(result) hands the value to callers under Policy::Exceptions
+// (throwing through Error::exception() on failure), and catch_to_expected<E>(f)
+// calls throwing code from the inside. Conversions run out-of-line, and don't
+// call the failure hook again
 
-// "Functor" based overload: it takes one functor as template parameter,
-// defining static exception() and unexpected() methods
-template <typename R, typename E, typename Functor, Policy P = DefaultPolicy,
-          typename... Args>
-  requires ErrorFunctor<Functor, E, Args...>
-constexpr auto make_failure(Args &&...args) -> ResultType<R, E, P> {
-  if constexpr (P == Policy::Exceptions) {
-    throw Functor::exception(std::forward<Args>(args)...);
+template <typename T>
+  requires detail::ExpectedResult<T>
+constexpr auto throw_if_error(T &&result) -> detail::Unwrapped<T> {
+  using Error = typename std::remove_cvref_t<T>::error_type;
+  if (!result.has_value()) [[unlikely]] {
+    if constexpr (std::is_same_v<Error, std::exception_ptr>) {
+      detail::rethrow_cold(result.error());
+    } else {
+      detail::convert_failure<void, Policy::Exceptions>(
+          std::forward<T>(result).error());
+    }
+  }
+  if constexpr (!std::is_void_v<detail::Unwrapped<T>>) {
+    return *std::forward<T>(result);
+  }
+}
+
+namespace detail {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+// Error of the exception being handled: the Error of a light_exception<E>, or
+// the exception itself for Errors constructible from a std::exception_ptr.
+// Other exceptions are rethrown
+template <typename E> EXPECTION_COLD auto caught_error() -> E {
+  if constexpr (std::is_trivially_copyable_v<E>) {
+    try {
+      throw;
+    } catch (const light_exception<E> &exception) {
+      return exception.error();
+    } catch (...) {
+    }
+  }
+  if constexpr (std::constructible_from<E, std::exception_ptr>) {
+    return E(std::current_exception());
   } else {
-    return Functor::unexpected(std::forward<Args>(args)...);
+    throw;
   }
 }
+#endif
+} // namespace detail
+
+template <typename E = std::exception_ptr, typename F, typename... Args>
+  requires std::invocable<F, Args...>
+auto catch_to_expected(F &&f, Args &&...args)
+    -> std::expected<std::invoke_result_t<F, Args...>, E> {
+  using Result = std::expected<std::invoke_result_t<F, Args...>, E>;
+  auto call = [&]() -> Result {
+    if constexpr (std::is_void_v<std::invoke_result_t<F, Args...>>) {
+      std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+      return Result();
+    } else {
+      return Result(std::in_place, std::invoke(std::forward<F>(f),
+                                               std::forward<Args>(args)...));
+    }
+  };
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  try {
+    return call();
+  } catch (...) {
+    return Result(std::unexpect, detail::caught_error<E>());
+  }
+#else
+  return call();
+#endif
+}
 
-// Callable based approach
-template <typename T, typename... Args>
-concept ExceptionCallable = requires(T &&t, Args &&...args) {
-  { t(std::forward<Args>(args)...) } -> std::derived_from<std::exception>;
+// === Explicit Instantiation ===
+// Instantiates policy-templated functions once, instead of in every
+// translation unit using them. In the header declaring the function:
+//   EXPECTION_DECLARE_POLICIES(divide_by);
+// And in exactly one source file, after its definition:
+//   EXPECTION_INSTANTIATE_POLICIES(divide_by);
+// Template arguments preceding the Policy go after the function name, e.g.
+// EXPECTION_DECLARE_POLICIES(divide_by, FailureMethod::InPlace) for
+// divide_by<FailureMethod::InPlace, P>. The function template must not be
+// overloaded
+
+#define EXPECTION_POLICY_SPECIALIZATION(P, fn, ...)                            \
+  fn<__VA_ARGS__ __VA_OPT__(, )::Expection::Policy::P>
+
+// Single policy versions, e.g. EXPECTION_DECLARE_POLICY(Abort, divide_by)
+#define EXPECTION_DECLARE_POLICY(P, fn, ...)                                   \
+  extern template decltype(EXPECTION_POLICY_SPECIALIZATION(P, fn,              \
+                                                           __VA_ARGS__))       \
+      EXPECTION_POLICY_SPECIALIZATION(P, fn, __VA_ARGS__)
+
+#define EXPECTION_INSTANTIATE_POLICY(P, fn, ...)                               \
+  template decltype(EXPECTION_POLICY_SPECIALIZATION(P, fn, __VA_ARGS__))       \
+      EXPECTION_POLICY_SPECIALIZATION(P, fn, __VA_ARGS__)
+
+// Exceptions and Expected versions
+#define EXPECTION_DECLARE_POLICIES(fn, ...)                                    \
+  EXPECTION_DECLARE_POLICY(Exceptions, fn, __VA_ARGS__);                       \
+  EXPECTION_DECLARE_POLICY(Expected, fn, __VA_ARGS__)
+
+#define EXPECTION_INSTANTIATE_POLICIES(fn, ...)                                \
+  EXPECTION_INSTANTIATE_POLICY(Exceptions, fn, __VA_ARGS__);                   \
+  EXPECTION_INSTANTIATE_POLICY(Expected, fn, __VA_ARGS__)
+
+// === Pipelines ===
+// pipe(result) | then(f) | map(g) | or_else(h) | map_error(i)
+// Results of type std::expected are chained through their monadic operations,
+// results of any other type (under the throwing/aborting policies) are passed
+// straight to the next function, and or_else/map_error are no-ops since errors
+// never reach the pipeline
+
+namespace detail {
+template <typename F> struct Then {
+  F f;
 };
 
-template <typename T, typename Error, typename... Args>
-concept UnexpectedCallable = requires(T &&t, Args &&...args) {
-  { t(std::forward<Args>(args)...) } -> std::same_as<std::unexpected<Error>>;
+template <typename F> struct Map {
+  F f;
 };
 
-// "Makes" a failure object by directly calling the appropriate callable with
-// arguments
-template <typename Result, typename Error, Policy P = DefaultPolicy,
-          typename Unexpected, typename Exception, typename... Args>
-  requires UnexpectedCallable<Unexpected, Error, Args...> &&
-           ExceptionCallable<Exception, Args...>
-constexpr auto make_failure(Unexpected &&unexpected, Exception &&exception,
-                            Args &&...args) -> ResultType<Result, Error, P> {
-  if constexpr (P == Policy::Exceptions) {
-    throw exception(std::forward<Args>(args)...);
+template <typename F> struct OrElse {
+  F f;
+};
+
+template <typename F> struct MapError {
+  F f;
+};
+} // namespace detail
+
+// Starts a pipeline, without copying the result
+template <typename T> constexpr auto pipe(T &&result) -> T && {
+  return std::forward<T>(result);
+}
+
+// Chains a function returning a ResultType
+template <typename F> constexpr auto then(F &&f) {
+  return detail::Then<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+// Chains a function returning a plain value
+template <typename F> constexpr auto map(F &&f) {
+  return detail::Map<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+// Recovers from an error with a function returning a ResultType
+template <typename F> constexpr auto or_else(F &&f) {
+  return detail::OrElse<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+// Converts the error with a function returning the new error
+template <typename F> constexpr auto map_error(F &&f) {
+  return detail::MapError<std::decay_t<F>>{std::forward<F>(f)};
+}
+
+// The std::expected operations below follow and_then, transform, or_else and
+// transform_error, which not every standard library providing <expected> has.
+// They live with the step types, to be found by argument-dependent lookup
+
+namespace detail {
+template <typename T, typename F>
+constexpr auto operator|(T &&result, Then<F> step) {
+  if constexpr (ExpectedResult<T>) {
+    using Value = typename std::remove_cvref_t<T>::value_type;
+    if constexpr (std::is_void_v<Value>) {
+      using Next = std::remove_cvref_t<std::invoke_result_t<F>>;
+      if (result.has_value()) {
+        return Next(std::invoke(std::move(step.f)));
+      }
+      return Next(std::unexpect, std::forward<T>(result).error());
+    } else {
+      using Next = std::remove_cvref_t<
+          std::invoke_result_t<F, decltype(*std::forward<T>(result))>>;
+      if (result.has_value()) {
+        return Next(std::invoke(std::move(step.f), *std::forward<T>(result)));
+      }
+      return Next(std::unexpect, std::forward<T>(result).error());
+    }
   } else {
-    return unexpected(std::forward<Args>(args)...);
+    return std::invoke(std::move(step.f), std::forward<T>(result));
   }
 }
 
-// Static constructor based approach
-template <typename T, typename... Args>
-concept ExceptionConstructable = requires(Args &&...args) {
-  {
-    T::exception(std::forward<Args>(args)...)
-  } -> std::derived_from<std::exception>;
+template <typename T, typename F>
+constexpr auto operator|(T &&result, Map<F> step) {
+  if constexpr (ExpectedResult<T>) {
+    using Value = typename std::remove_cvref_t<T>::value_type;
+    using Error = typename std::remove_cvref_t<T>::error_type;
+    if constexpr (std::is_void_v<Value>) {
+      using Next =
+          std::expected<std::remove_cv_t<std::invoke_result_t<F>>, Error>;
+      if (!result.has_value()) {
+        return Next(std::unexpect, std::forward<T>(result).error());
+      }
+      if constexpr (std::is_void_v<typename Next::value_type>) {
+        std::invoke(std::move(step.f));
+        return Next();
+      } else {
+        return Next(std::in_place, std::invoke(std::move(step.f)));
+      }
+    } else {
+      using Next = std::expected<
+          std::remove_cv_t<
+              std::invoke_result_t<F, decltype(*std::forward<T>(result))>>,
+          Error>;
+      if (!result.has_value()) {
+        return Next(std::unexpect, std::forward<T>(result).error());
+      }
+      if constexpr (std::is_void_v<typename Next::value_type>) {
+        std::invoke(std::move(step.f), *std::forward<T>(result));
+        return Next();
+      } else {
+        return Next(std::in_place,
+                    std::invoke(std::move(step.f), *std::forward<T>(result)));
+      }
+    }
+  } else {
+    return std::invoke(std::move(step.f), std::forward<T>(result));
+  }
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T &&result, [[maybe_unused]] OrElse<F> step) {
+  if constexpr (ExpectedResult<T>) {
+    using Value = typename std::remove_cvref_t<T>::value_type;
+    using Next = std::remove_cvref_t<
+        std::invoke_result_t<F, decltype(std::forward<T>(result).error())>>;
+    if (!result.has_value()) {
+      return Next(
+          std::invoke(std::move(step.f), std::forward<T>(result).error()));
+    }
+    if constexpr (std::is_void_v<Value>) {
+      return Next();
+    } else {
+      return Next(std::in_place, *std::forward<T>(result));
+    }
+  } else {
+    return std::remove_cvref_t<T>(std::forward<T>(result));
+  }
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T &&result, [[maybe_unused]] MapError<F> step) {
+  if constexpr (ExpectedResult<T>) {
+    using Value = typename std::remove_cvref_t<T>::value_type;
+    using Next = std::expected<
+        Value, std::remove_cv_t<std::invoke_result_t<
+                   F, decltype(std::forward<T>(result).error())>>>;
+    if (!result.has_value()) {
+      return Next(std::unexpect, std::invoke(std::move(step.f),
+                                             std::forward<T>(result).error()));
+    }
+    if constexpr (std::is_void_v<Value>) {
+      return Next();
+    } else {
+      return Next(std::in_place, *std::forward<T>(result));
+    }
+  } else {
+    return std::remove_cvref_t<T>(std::forward<T>(result));
+  }
+}
+} // namespace detail
+
+// === Error Propagation ===
+// auto value = EXPECTION_TRY(expr);
+// If expr is a std::expected holding an error, the error is moved out and
+// returned from the enclosing function. Otherwise, the macro evaluates to the
+// held value (or void). Results of any other type are passed through as-is,
+// so under the throwing/aborting policies it is a no-op.
+// Under those policies, the enclosing function's return type can't be void
+// unless it is a template (where the propagation is discarded entirely)
+
+namespace detail {
+// Placeholder for void expressions, so EXPECTION_TRY can bind any result
+struct TryVoid {};
+
+// Evaluates the expression, returning its result without copies or moves
+template <typename F> constexpr decltype(auto) try_evaluate(F &&expression) {
+  if constexpr (std::is_void_v<std::invoke_result_t<F>>) {
+    std::forward<F>(expression)();
+    return TryVoid{};
+  } else {
+    return std::forward<F>(expression)();
+  }
+}
+
+// Converts to any return type, for the never-taken propagation of results
+// that aren't std::expected
+struct TryNever {
+  template <typename T> constexpr operator T() const { std::unreachable(); }
 };
 
-// "Makes" a failure object by directly calling a constructor with arguments
-template <typename Result, typename Error, Policy P = DefaultPolicy,
-          typename... Args>
-  requires ExceptionConstructable<Error, Args...>
-constexpr auto make_failure(Args &&...args) -> ResultType<Result, Error, P> {
-  if constexpr (P == Policy::Exceptions) {
-    throw Error::exception(std::forward<Args>(args)...);
+template <typename T> constexpr bool try_failed(const T &result) {
+  if constexpr (ExpectedResult<T>) {
+    return !result.has_value();
   } else {
-    return std::unexpected(Error{std::forward<Args>(args)...});
+    return false;
   }
 }
 
-// Conversion based approach
-template <typename T>
-concept ExceptionConvertible = requires(T &&t) {
-  { t.exception() } -> std::derived_from<std::exception>;
+template <typename T> constexpr auto try_error(T &&result) {
+  if constexpr (ExpectedResult<T>) {
+    using Error = typename std::remove_cvref_t<T>::error_type;
+    return std::unexpected<Error>(std::forward<T>(result).error());
+  } else {
+    return TryNever{};
+  }
+}
+
+template <typename T> constexpr decltype(auto) try_value(T &&result) {
+  if constexpr (ExpectedResult<T>) {
+    if constexpr (std::is_void_v<typename std::remove_cvref_t<T>::value_type>) {
+      return;
+    } else {
+      return *std::forward<T>(result);
+    }
+  } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, TryVoid>) {
+    return;
+  } else {
+    return std::forward<T>(result);
+  }
+}
+} // namespace detail
+
+#define EXPECTION_TRY_CONCAT_(a, b) a##b
+#define EXPECTION_TRY_CONCAT(a, b) EXPECTION_TRY_CONCAT_(a, b)
+
+// Statement form, available on every compiler: EXPECTION_TRY_ASSIGN(auto x,
+// expr) declares (or assigns to) x from a non-void result
+#define EXPECTION_TRY_ASSIGN(lhs, ...)                                         \
+  EXPECTION_TRY_ASSIGN_IMPL(lhs,                                               \
+                            EXPECTION_TRY_CONCAT(expection_try_, __LINE__),    \
+                            __VA_ARGS__)
+
+#define EXPECTION_TRY_ASSIGN_IMPL(lhs, result, ...)                            \
+  auto &&result = ::Expection::detail::try_evaluate(                           \
+      [&]() -> decltype(auto) { return (__VA_ARGS__); });                      \
+  if constexpr (::Expection::detail::ExpectedResult<decltype(result)>) {       \
+    if (::Expection::detail::try_failed(result)) [[unlikely]] {                \
+      return ::Expection::detail::try_error(                                   \
+          ::std::forward<decltype(result)>(result));                           \
+    }                                                                          \
+  }                                                                            \
+  lhs = ::Expection::detail::try_value(::std::forward<decltype(result)>(result))
+
+// Expression form, using statement expressions (GCC and Clang). Prefer
+// EXPECTION_TRY_ASSIGN in constexpr functions, GCC doesn't evaluate statement
+// expressions at compile time
+#if defined(__GNUC__) || defined(__clang__)
+#define EXPECTION_TRY(...)                                                     \
+  ({                                                                           \
+    auto &&expection_try_result = ::Expection::detail::try_evaluate(           \
+        [&]() -> decltype(auto) { return (__VA_ARGS__); });                    \
+    if constexpr (::Expection::detail::ExpectedResult<                         \
+                      decltype(expection_try_result)>) {                       \
+      if (::Expection::detail::try_failed(expection_try_result)) [[unlikely]] {\
+        return ::Expection::detail::try_error(                                 \
+            ::std::forward<decltype(expection_try_result)>(                    \
+                expection_try_result));                                        \
+      }                                                                        \
+    }                                                                          \
+    ::Expection::detail::try_value(                                            \
+        ::std::forward<decltype(expection_try_result)>(expection_try_result)); \
+  })
+#endif
+
+// === Compile-time Evaluation ===
+// Under the Expected/Compact/Dynamic policies, failure helpers are usable in
+// constant expressions, so tables can be computed at compile time from
+// fallible functions. These turn a failure into a compilation error naming
+// Error::err_to_str()'s message
+
+namespace detail {
+template <std::size_t N> struct CompileTimeMessage {
+  char text[N];
 };
 
-// This one doesn't "make" a failure, it accepts an existing "Error" object with
-// a .exception() conversion
-template <typename Result, Policy P = DefaultPolicy, ExceptionConvertible E>
-constexpr auto failure(E &&error) -> ResultType<Result, std::decay_t<E>, P> {
-  if constexpr (P == Policy::Exceptions) {
-    throw error.exception();
+template <typename Error>
+constexpr auto message_length(const Error &error) -> std::size_t {
+  const char *message = error_message<Error>(error);
+  std::size_t length = 0;
+  while (message[length] != '\0') {
+    ++length;
+  }
+  return length;
+}
+
+// Instantiated with the message of the failure, which compilers print
+template <CompileTimeMessage Message> struct FailedAtCompileTime {
+  static_assert(sizeof(Message) == 0,
+                "failure during constant evaluation, see the message in the "
+                "FailedAtCompileTime instantiation above");
+  static constexpr bool value = false;
+};
+} // namespace detail
+
+// Returns the held value of a result computed at compile time, or stops
+// compilation. Arguments must be constants: inside loops, call it from a
+// consteval function (or lambda)
+template <typename T> consteval auto value_or_compile_error(T result) {
+  if constexpr (detail::ExpectedResult<T>) {
+    if (!result.has_value()) {
+      detail::failed_at_compile_time(
+          detail::error_message<typename T::error_type>(result.error()));
+    }
+    if constexpr (!std::is_void_v<typename T::value_type>) {
+      return *std::move(result);
+    }
   } else {
-    return std::unexpected<std::decay_t<E>>(std::forward<E>(error));
+    return result;
   }
 }
+
+// Same for a captureless lambda computing the result, e.g.
+//   constexpr auto half = value_or_compile_error<[] { return divide(1, 2); }>();
+// The failure's message is spelled out in the diagnostic on every compiler
+template <auto Expression> consteval auto value_or_compile_error() {
+  constexpr auto result = Expression();
+  using Result = std::remove_cv_t<decltype(result)>;
+
+  if constexpr (detail::ExpectedResult<Result>) {
+    if constexpr (!result.has_value()) {
+      constexpr auto message = [] {
+        constexpr auto error = Expression().error();
+        constexpr auto length = detail::message_length(error);
+        const char *text =
+            detail::error_message<typename Result::error_type>(error);
+        detail::CompileTimeMessage<length + 1> copy{};
+        for (std::size_t i = 0; i < length; ++i) {
+          copy.text[i] = text[i];
+        }
+        return copy;
+      }();
+      static_assert(detail::FailedAtCompileTime<message>::value);
+    } else if constexpr (!std::is_void_v<typename Result::value_type>) {
+      return *result;
+    }
+  } else {
+    return result;
+  }
+}
+
+// === Error Codes ===
+
+// Enumerations usable as ErrorCode kinds: err_to_str(kind) must be found
+// through argument-dependent lookup
+template <typename Enum>
+concept ErrorEnum = std::is_enum_v<Enum> && requires(Enum kind) {
+  { err_to_str(kind) } -> std::convertible_to<const char *>;
+};
+
+namespace detail {
+template <typename Enum> constexpr auto enum_to_str(Enum kind) -> const char * {
+  return err_to_str(kind);
+}
+
+template <typename Enum, typename Payload> struct ErrorCodeStorage {
+  Enum kind;
+  Payload payload{};
+};
+
+template <typename Enum> struct ErrorCodeStorage<Enum, void> {
+  Enum kind;
+};
+} // namespace detail
+
+// Compact, trivially copyable Error: an enumerator, and optionally a payload
+// of at most 32 bits. Usable with every make_failure/failure overload, either
+// as the Error type or as its own Functor
+template <ErrorEnum Enum, typename Payload = void>
+  requires std::is_void_v<Payload> ||
+           (std::is_trivially_copyable_v<Payload> &&
+            sizeof(Payload) <= sizeof(std::uint32_t))
+struct ErrorCode : detail::ErrorCodeStorage<Enum, Payload> {
+  using Kind = Enum;
+
+  constexpr ErrorCode(Kind kind)
+      : detail::ErrorCodeStorage<Enum, Payload>{kind} {}
+
+  template <typename P = Payload>
+    requires(!std::is_void_v<P>)
+  constexpr ErrorCode(Kind kind, P payload)
+      : detail::ErrorCodeStorage<Enum, Payload>{kind, payload} {}
+
+  static constexpr auto err_to_str(Kind kind) -> const char * {
+    return detail::enum_to_str(kind);
+  }
+
+  constexpr auto str() const { return err_to_str(this->kind); }
+
+  // In-place exception construction
+  template <typename... Args>
+    requires std::constructible_from<ErrorCode, Args...>
+  static auto exception(Args... args) {
+    return ErrorCode(args...).exception();
+  }
+
+  // In-place unexpected construction
+  template <typename... Args>
+    requires std::constructible_from<ErrorCode, Args...>
+  static constexpr auto unexpected(Args... args) {
+    return std::unexpected<ErrorCode>(std::in_place, args...);
+  }
+
+  // Convert to exception
+  auto exception() const { return std::runtime_error(str()); }
+
+  friend constexpr bool operator==(const ErrorCode &,
+                                   const ErrorCode &) = default;
+};
+
+// ErrorCodes without payload are stored by kind in compact_expected
+template <ErrorEnum Enum> struct niche_error<ErrorCode<Enum>> {
+  static constexpr auto index(const ErrorCode<Enum> &error) -> std::size_t {
+    return static_cast<std::size_t>(error.kind);
+  }
+
+  static constexpr auto error(std::size_t index) -> ErrorCode<Enum> {
+    return ErrorCode<Enum>(static_cast<Enum>(index));
+  }
+};
 } // namespace Expection
 
 #endif // ifndef EXPECTION_HPP
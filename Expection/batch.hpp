@@ -0,0 +1,181 @@
+#pragma once
+#ifndef EXPECTION_BATCH_HPP
+#define EXPECTION_BATCH_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../Expection.hpp"
+
+namespace Expection {
+
+namespace detail {
+struct ResultSpanAccess;
+} // namespace detail
+
+// === Batches ===
+// Element-wise kernels over columns: values are written to a dense output
+// column, validity is tracked in a packed bitmap and errors in a sparse
+// side-table. Policy dispatch happens once per batch instead of once per
+// element, so the kernel loop itself stays branch-free and vectorizable
+
+// Result of a batch: under Policy::Expected (and Dynamic), a view over the
+// output column plus the validity bitmap and errors. Under the other policies
+// failures never make it into a ResultSpan, so every element is valid
+template <typename R, typename E, Policy P = DefaultPolicy> class ResultSpan {
+public:
+  static constexpr std::size_t WordBits = 64;
+
+  explicit ResultSpan(std::span<R> values) : values_(values) {
+    if constexpr (ReturnsExpected<P>) {
+      validity_.assign((values.size() + WordBits - 1) / WordBits, ~0ULL);
+    }
+  }
+
+  auto size() const { return values_.size(); }
+
+  // The dense output column, including the (unspecified) values of invalid
+  // elements
+  auto values() const { return values_; }
+
+  auto has_value(std::size_t i) const -> bool {
+    if constexpr (ReturnsExpected<P>) {
+      return (validity_[i / WordBits] >> (i % WordBits)) & 1;
+    } else {
+      return true;
+    }
+  }
+
+  auto all_valid() const -> bool { return errors_.empty(); }
+
+  auto error_count() const { return errors_.size(); }
+
+  // Bit i of word i / 64 is set if element i is valid. Bits past the end of
+  // the column are set
+  auto validity() const -> std::span<const std::uint64_t> { return validity_; }
+
+  // (index, error) pairs, sorted by index
+  auto errors() const -> std::span<const std::pair<std::size_t, E>> {
+    return errors_;
+  }
+
+  // The error of element i, nullptr if it is valid
+  auto error(std::size_t i) const -> const E * {
+    if (has_value(i)) {
+      return nullptr;
+    }
+    auto it = std::lower_bound(errors_.begin(), errors_.end(), i,
+                               [](const auto &entry, std::size_t index) {
+                                 return entry.first < index;
+                               });
+    return &it->second;
+  }
+
+private:
+  std::span<R> values_;
+  std::vector<std::uint64_t> validity_;
+  std::vector<std::pair<std::size_t, E>> errors_;
+
+  friend struct detail::ResultSpanAccess;
+};
+
+namespace detail {
+struct ResultSpanAccess {
+  template <typename Span> static auto &validity(Span &span) {
+    return span.validity_;
+  }
+
+  template <typename Span> static auto &errors(Span &span) {
+    return span.errors_;
+  }
+};
+} // namespace detail
+
+// Runs kernel(out[i], columns[i]...) -> bool over every element of out, where
+// the kernel writes the value and returns whether it is valid. For invalid
+// elements, make_error(columns[i]...) builds the Error (sparsely, after the
+// kernel loop). Columns are contiguous ranges at least as long as out.
+// The kernel loop vectorizes when the kernel is branch-free: compute the value
+// unconditionally (when that is safe) rather than guarding it.
+// Under Exceptions, the first failure is thrown as by failure(), or from
+// Error::exception(kind) for Errors without a conversion.
+// Under Accumulate, every failure is appended to the active ErrorList<E>, and
+// its element set to poisoned<R>
+template <typename R, typename E, Policy P = DefaultPolicy, typename Kernel,
+          typename MakeError, typename... Columns>
+auto transform_batch(std::span<R> out, Kernel kernel, MakeError make_error,
+                     const Columns &...columns) -> ResultSpan<R, E, P> {
+  static_assert(
+      std::is_same_v<std::invoke_result_t<Kernel &, R &,
+                                          decltype(std::data(columns)[0])...>,
+                     bool>,
+      "kernel(out[i], columns[i]...) must return whether out[i] is valid");
+
+  constexpr auto WordBits = ResultSpan<R, E, P>::WordBits;
+  ResultSpan<R, E, P> result(out);
+  auto &validity = detail::ResultSpanAccess::validity(result);
+
+  auto fail = [&](std::size_t i) {
+    auto error = std::invoke(make_error, std::data(columns)[i]...);
+    detail::on_failure<E, P>(std::source_location{}, error);
+    return error;
+  };
+
+  for (std::size_t base = 0; base < out.size(); base += WordBits) {
+    const auto count = std::min(WordBits, out.size() - base);
+
+    // Kernel loop: validity goes through a byte per element, which keeps the
+    // loop vectorizable, before being packed into the bitmap word
+    std::uint8_t valid[WordBits];
+    for (std::size_t j = 0; j < count; ++j) {
+      const auto i = base + j;
+      valid[j] = std::invoke(kernel, out[i], std::data(columns)[i]...);
+    }
+
+    std::uint64_t bits = count < WordBits ? ~0ULL << count : 0;
+    for (std::size_t j = 0; j < count; ++j) {
+      bits |= static_cast<std::uint64_t>(valid[j]) << j;
+    }
+
+    if (bits == ~0ULL) [[likely]] {
+      continue;
+    }
+
+    if constexpr (P == Policy::Exceptions) {
+      detail::convert_failure<R, P>(fail(base + std::countr_one(bits)));
+    } else if constexpr (ReturnsExpected<P>) {
+      validity[base / WordBits] = bits;
+    } else if constexpr (P == Policy::Accumulate) {
+      for (auto invalid = ~bits; invalid != 0; invalid &= invalid - 1) {
+        const auto i = base + std::countr_zero(invalid);
+        out[i] = detail::accumulate<R>(fail(i));
+      }
+    } else {
+      detail::abandon<P>();
+    }
+  }
+
+  // Sparse pass over the invalid elements
+  if constexpr (ReturnsExpected<P>) {
+    auto &errors = detail::ResultSpanAccess::errors(result);
+    for (std::size_t word = 0; word < validity.size(); ++word) {
+      for (auto invalid = ~validity[word]; invalid != 0;
+           invalid &= invalid - 1) {
+        const auto i = word * WordBits + std::countr_zero(invalid);
+        errors.emplace_back(i, fail(i));
+      }
+    }
+  }
+
+  return result;
+}
+} // namespace Expection
+
+#endif // ifndef EXPECTION_BATCH_HPP
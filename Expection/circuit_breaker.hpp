@@ -0,0 +1,373 @@
+#pragma once
+#ifndef EXPECTION_CIRCUIT_BREAKER_HPP
+#define EXPECTION_CIRCUIT_BREAKER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "core.hpp"
+
+// Per-Error-type circuit breakers, fed by the failure helpers: every
+// make_failure/failure of Error made inside breaker::call<Error, P>() counts
+// into an atomic sliding window, and once the failure ratio of those calls
+// reaches the configured threshold, the breaker opens and those calls return
+// a prebuilt error (or rethrow a prebuilt exception) without running. After a
+// cooldown, a single trial call is let through: its success closes the
+// breaker, its failure opens it again. Enabled by defining
+// EXPECTION_CIRCUIT_BREAKER before including Expection.hpp (which then
+// includes this header)
+#ifndef EXPECTION_CIRCUIT_BREAKER
+#error "Define EXPECTION_CIRCUIT_BREAKER before including Expection.hpp"
+#endif
+
+// Number of buckets the window is divided into: counts expire one bucket at a
+// time
+#ifndef EXPECTION_BREAKER_BUCKETS
+#define EXPECTION_BREAKER_BUCKETS 8
+#endif
+
+// Calls are counted per thread, and added to the window every
+// EXPECTION_BREAKER_FLUSH_EVERY calls, or at the thread's next failure
+#ifndef EXPECTION_BREAKER_FLUSH_EVERY
+#define EXPECTION_BREAKER_FLUSH_EVERY 64
+#endif
+
+namespace Expection::breaker {
+
+inline constexpr std::size_t Buckets = EXPECTION_BREAKER_BUCKETS;
+inline constexpr std::uint32_t FlushEvery = EXPECTION_BREAKER_FLUSH_EVERY;
+
+static_assert(Buckets != 0, "EXPECTION_BREAKER_BUCKETS must not be 0");
+static_assert(FlushEvery != 0, "EXPECTION_BREAKER_FLUSH_EVERY must not be 0");
+
+struct Config {
+  // Opens when failures / calls over the window reaches it...
+  double failure_ratio = 0.5;
+  // ...and at least this many calls were counted
+  std::uint32_t minimum_calls = 100;
+  std::chrono::nanoseconds window = std::chrono::seconds(10);
+  // Time spent open before a trial call is let through
+  std::chrono::nanoseconds cooldown = std::chrono::seconds(5);
+};
+
+enum class State : std::uint8_t { Closed, Open, HalfOpen };
+
+namespace detail {
+inline auto now() -> std::int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Counts of a window_ / Buckets slice of time. A bucket is reset by the first
+// thread reaching it in a new slice: counts added concurrently by others may
+// be lost, which only makes the ratio approximate
+struct alignas(64) Bucket {
+  std::atomic<std::int64_t> epoch{std::numeric_limits<std::int64_t>::min()};
+  std::atomic<std::uint32_t> calls{0};
+  std::atomic<std::uint32_t> failures{0};
+};
+
+// Everything but the short-circuit result, shared by every Error type
+class Window {
+public:
+  void configure(const Config &config) {
+    ratio_ = config.failure_ratio;
+    minimum_calls_ = config.minimum_calls;
+    slice_ = std::max<std::int64_t>(config.window.count() / Buckets, 1);
+    cooldown_ = config.cooldown.count();
+    reset();
+    configured_.store(true, std::memory_order_release);
+  }
+
+  auto configured() const -> bool {
+    return configured_.load(std::memory_order_acquire);
+  }
+
+  auto state() const -> State { return state_.load(std::memory_order_relaxed); }
+
+  void add(std::uint32_t calls, std::uint32_t failures, std::int64_t time) {
+    const auto epoch = time / slice_;
+    auto &bucket = buckets_[static_cast<std::size_t>(epoch) % Buckets];
+    auto seen = bucket.epoch.load(std::memory_order_acquire);
+    if (seen != epoch &&
+        bucket.epoch.compare_exchange_strong(seen, epoch,
+                                             std::memory_order_acq_rel)) {
+      bucket.calls.store(0, std::memory_order_relaxed);
+      bucket.failures.store(0, std::memory_order_relaxed);
+    }
+    if (calls != 0) {
+      bucket.calls.fetch_add(calls, std::memory_order_relaxed);
+    }
+    if (failures != 0) {
+      bucket.failures.fetch_add(failures, std::memory_order_relaxed);
+    }
+  }
+
+  // Adds a failure, and opens the breaker if it crosses the threshold (or if
+  // it is the trial call's)
+  void fail(std::uint32_t calls, std::int64_t time) {
+    add(calls, 1, time);
+    auto state = state_.load(std::memory_order_relaxed);
+    if (state == State::HalfOpen || (state == State::Closed && tripped(time))) {
+      open(state, time);
+    }
+  }
+
+  // Whether the caller may run: always when closed, and when open only as the
+  // trial call, once the cooldown elapsed
+  enum class Admission { Run, Trial, ShortCircuit };
+
+  auto admit(std::int64_t time) -> Admission {
+    auto state = state_.load(std::memory_order_acquire);
+    if (state == State::Closed) {
+      return Admission::Run;
+    }
+    if (state == State::Open &&
+        time >= open_until_.load(std::memory_order_relaxed) &&
+        state_.compare_exchange_strong(state, State::HalfOpen,
+                                       std::memory_order_acq_rel)) {
+      return Admission::Trial;
+    }
+    short_circuits_.fetch_add(1, std::memory_order_relaxed);
+    return Admission::ShortCircuit;
+  }
+
+  // Outcome of the trial call
+  void close() {
+    auto state = State::HalfOpen;
+    reset_counts();
+    state_.compare_exchange_strong(state, State::Closed,
+                                   std::memory_order_acq_rel);
+  }
+
+  void reopen(std::int64_t time) { open(State::HalfOpen, time); }
+
+  auto short_circuits() const -> std::uint64_t {
+    return short_circuits_.load(std::memory_order_relaxed);
+  }
+
+private:
+  auto tripped(std::int64_t time) const -> bool {
+    const auto epoch = time / slice_;
+    std::uint64_t calls = 0;
+    std::uint64_t failures = 0;
+    for (const auto &bucket : buckets_) {
+      const auto seen = bucket.epoch.load(std::memory_order_acquire);
+      if (seen <= epoch && seen > epoch - static_cast<std::int64_t>(Buckets)) {
+        calls += bucket.calls.load(std::memory_order_relaxed);
+        failures += bucket.failures.load(std::memory_order_relaxed);
+      }
+    }
+    return calls >= minimum_calls_ &&
+           static_cast<double>(failures) >= ratio_ * static_cast<double>(calls);
+  }
+
+  void open(State from, std::int64_t time) {
+    open_until_.store(time + cooldown_, std::memory_order_relaxed);
+    state_.compare_exchange_strong(from, State::Open,
+                                   std::memory_order_acq_rel);
+  }
+
+  void reset_counts() {
+    for (auto &bucket : buckets_) {
+      bucket.epoch.store(std::numeric_limits<std::int64_t>::min(),
+                         std::memory_order_relaxed);
+      bucket.calls.store(0, std::memory_order_relaxed);
+      bucket.failures.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void reset() {
+    reset_counts();
+    short_circuits_.store(0, std::memory_order_relaxed);
+    state_.store(State::Closed, std::memory_order_relaxed);
+  }
+
+  std::atomic<State> state_{State::Closed};
+  std::atomic<std::int64_t> open_until_{0};
+  std::atomic<std::uint64_t> short_circuits_{0};
+  std::atomic<bool> configured_{false};
+  double ratio_ = 1;
+  std::uint32_t minimum_calls_ = 0;
+  std::int64_t slice_ = 1;
+  std::int64_t cooldown_ = 0;
+  Bucket buckets_[Buckets];
+};
+
+template <typename Error> struct Breaker {
+  static inline Window window;
+  static inline std::optional<Error> open_error;
+  static inline std::exception_ptr open_exception;
+  // Calls of this thread not yet added to the window
+  static inline thread_local std::uint32_t pending = 0;
+  // Calls of this thread running through the breaker: failures made outside
+  // of them aren't counted
+  static inline thread_local std::uint32_t depth = 0;
+};
+
+template <typename Error> struct InsideCall {
+  InsideCall() { ++Breaker<Error>::depth; }
+  ~InsideCall() { --Breaker<Error>::depth; }
+  InsideCall(const InsideCall &) = delete;
+  InsideCall &operator=(const InsideCall &) = delete;
+};
+
+// Whether Result is a ResultType<R, Error, P>
+template <typename Result, typename Error, Policy P>
+concept ResultOf =
+    !ReturnsExpected<P> ||
+    (::Expection::detail::ExpectedResult<Result> &&
+     std::is_same_v<Result,
+                    ResultType<typename Result::value_type, Error, P>>);
+
+template <typename Error> EXPECTION_COLD void flush() {
+  auto &window = Breaker<Error>::window;
+  if (window.configured()) {
+    window.add(std::exchange(Breaker<Error>::pending, 0), 0, now());
+  }
+}
+
+template <typename Result, typename Error, Policy P>
+auto short_circuit() -> Result {
+  if constexpr (P == Policy::Exceptions) {
+    static_assert(ExceptionConvertible<Error> || ExceptionFromKind<Error> ||
+                      requires(Error &error) {
+                        {
+                          error.exception_ptr()
+                        } -> std::convertible_to<std::exception_ptr>;
+                      },
+                  "Short-circuiting under Policy::Exceptions requires an "
+                  "Error with exception_ptr(), exception() or a static "
+                  "exception(kind)");
+    ::Expection::detail::rethrow_cold(Breaker<Error>::open_exception);
+  } else if constexpr (ReturnsExpected<P>) {
+    return Result(std::unexpect, *Breaker<Error>::open_error);
+  } else if constexpr (P == Policy::Accumulate) {
+    return ::Expection::detail::accumulate<Result>(
+        Error(*Breaker<Error>::open_error));
+  } else {
+    ::Expection::detail::abandon<P>();
+  }
+}
+
+// Calls that aren't plain closed-breaker calls: short-circuited, or trials
+template <typename Error, Policy P, typename F, typename... Args>
+EXPECTION_COLD auto guarded_call(F &&f, Args &&...args)
+    -> std::invoke_result_t<F, Args...> {
+  using Result = std::invoke_result_t<F, Args...>;
+  auto &window = Breaker<Error>::window;
+  const auto admission = window.admit(now());
+  if (admission == Window::Admission::ShortCircuit) {
+    return short_circuit<Result, Error, P>();
+  }
+  if (admission == Window::Admission::Run) {
+    return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+  }
+
+  // The trial reopens the breaker unless it succeeds: failures made through
+  // the helpers already did, this covers foreign exceptions
+  struct Trial {
+    Window &window;
+    bool succeeded = false;
+    ~Trial() {
+      if (!succeeded) {
+        window.reopen(now());
+      }
+    }
+  } trial{window};
+
+  if constexpr (std::is_void_v<Result>) {
+    std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    trial.succeeded = window.state() == State::HalfOpen;
+    if (trial.succeeded) {
+      window.close();
+    }
+  } else {
+    Result result =
+        std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+    if constexpr (ReturnsExpected<P>) {
+      trial.succeeded = result.has_value();
+    } else {
+      trial.succeeded = window.state() == State::HalfOpen;
+    }
+    if (trial.succeeded) {
+      window.close();
+    }
+    return result;
+  }
+}
+} // namespace detail
+
+// Enables the breaker of Error. open_error is returned (or its exception
+// thrown) by short-circuited calls: its exception_ptr(), exception(), or
+// Error::exception(open_error.kind). Must be called before calls are made
+// through the breaker, and not concurrently with them
+template <typename Error>
+void configure(const Config &config, Error open_error) {
+  using Breaker = detail::Breaker<Error>;
+  if constexpr (requires {
+                  { open_error.exception_ptr() } -> std::convertible_to<
+                                                     std::exception_ptr>;
+                }) {
+    Breaker::open_exception = open_error.exception_ptr();
+  } else if constexpr (ExceptionConvertible<Error>) {
+    Breaker::open_exception = std::make_exception_ptr(open_error.exception());
+  } else if constexpr (ExceptionFromKind<Error>) {
+    Breaker::open_exception =
+        std::make_exception_ptr(Error::exception(open_error.kind));
+  }
+  Breaker::open_error.emplace(std::move(open_error));
+  Breaker::window.configure(config);
+}
+
+template <typename Error> auto state() -> State {
+  return detail::Breaker<Error>::window.state();
+}
+
+// Number of calls short-circuited since the breaker was configured
+template <typename Error> auto short_circuits() -> std::uint64_t {
+  return detail::Breaker<Error>::window.short_circuits();
+}
+
+// Called by the failure helpers for every failure of Error, counted when made
+// inside breaker::call<Error, P>()
+template <typename Error> void record_failure() {
+  auto &window = detail::Breaker<Error>::window;
+  if (detail::Breaker<Error>::depth != 0 && window.configured()) {
+    window.fail(std::exchange(detail::Breaker<Error>::pending, 0),
+                detail::now());
+  }
+}
+
+// Calls f(args...), which returns a ResultType<R, Error, P>, unless the
+// breaker of Error is open. While it is closed, this costs a relaxed load and
+// thread-local increments
+template <typename Error, Policy P = DefaultPolicy, typename F,
+          typename... Args>
+auto call(F &&f, Args &&...args) -> std::invoke_result_t<F, Args...> {
+  static_assert(detail::ResultOf<std::invoke_result_t<F, Args...>, Error, P>,
+                "f must return a ResultType<R, Error, P>");
+  using Breaker = detail::Breaker<Error>;
+  const detail::InsideCall<Error> inside;
+  if (Breaker::window.state() != State::Closed) [[unlikely]] {
+    return detail::guarded_call<Error, P>(std::forward<F>(f),
+                                          std::forward<Args>(args)...);
+  }
+  if (++Breaker::pending == FlushEvery) [[unlikely]] {
+    detail::flush<Error>();
+  }
+  return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+}
+} // namespace Expection::breaker
+
+#endif // ifndef EXPECTION_CIRCUIT_BREAKER_HPP
@@ -0,0 +1,1164 @@
+#pragma once
+#ifndef EXPECTION_CORE_HPP
+#define EXPECTION_CORE_HPP
+
+// The policies, result types, success and failure helpers, and accessors:
+// everything most translation units need, with the fewest standard headers.
+// Expection.hpp adds ErrorList, allocator-aware errors, resolve(), pipelines,
+// EXPECTION_TRY, compile-time evaluation and ErrorCode
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <expected>
+#include <limits>
+#include <source_location>
+#include <type_traits>
+#include <utility>
+
+// Failure hook: if defined, EXPECTION_ON_FAILURE must name a function template
+// declared before this header. Every failure helper calls
+// EXPECTION_ON_FAILURE<Error>(args...) with const references to its arguments
+// before taking the policy's failure path. Defining EXPECTION_TELEMETRY selects
+// the failure counters of Expection/telemetry.hpp. Costs nothing when undefined
+#if defined(EXPECTION_TELEMETRY) && !defined(EXPECTION_ON_FAILURE)
+#include "telemetry.hpp"
+#define EXPECTION_ON_FAILURE ::Expection::telemetry::count_failure
+#endif
+
+// Failure site sampling: defining EXPECTION_SAMPLE_FAILURES records one failure
+// in EXPECTION_SAMPLE_EVERY into the ring buffer of Expection/sampling.hpp
+#ifdef EXPECTION_SAMPLE_FAILURES
+#include "sampling.hpp"
+#endif
+
+// Failure-rate profiles: defining EXPECTION_PROFILE counts the outcomes of
+// success() and failure() per function into Expection/profile.hpp
+#ifdef EXPECTION_PROFILE
+#include "profile.hpp"
+#endif
+
+// Circuit breakers: defining EXPECTION_CIRCUIT_BREAKER feeds every failure to
+// the breaker of its Error type, see Expection/circuit_breaker.hpp (included at
+// the end of this header)
+
+namespace Expection {
+
+// Exceptions: returns R, throws on failure
+// Expected: returns std::expected<R, E>
+// Abort: returns R, calls EXPECTION_ABORT_HANDLER on failure (usable with
+// -fno-exceptions)
+// Unchecked: returns R, failure is undefined behaviour (std::unreachable) when
+// NDEBUG is defined, and calls EXPECTION_ABORT_HANDLER otherwise
+// Dynamic: returns std::expected<R, E>, for functions compiled once (e.g. in a
+// shared library) and converted to the caller's policy with resolve<P>()
+// Compact: returns compact_expected<R, E>, which stores errors in spare values
+// of R when it has some, so that the result is no bigger than R
+// Accumulate: returns R, appends errors to the thread's active ErrorList<E>
+// and returns a poisoned<R> value, so that processing continues
+// Boundary: returns std::expected<R, E>, for the inner layers of a component
+// whose edge converts once, with throw_if_error() or catch_to_expected()
+enum class Policy {
+  Exceptions,
+  Expected,
+  Abort,
+  Unchecked,
+  Dynamic,
+  Compact,
+  Accumulate,
+  Boundary
+};
+
+#ifndef EXPECTION_DEFAULTPOLICY
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#define EXPECTION_DEFAULTPOLICY Exceptions
+#else
+#define EXPECTION_DEFAULTPOLICY Abort
+#endif
+#endif
+
+// Called by every failure helper under Policy::Abort. Must name a [[noreturn]]
+// callable taking no arguments
+#ifndef EXPECTION_ABORT_HANDLER
+#define EXPECTION_ABORT_HANDLER std::abort
+#endif
+
+// Portable assumption: the (side-effect free) expression is considered to
+// always be true by the optimizer
+#if __has_cpp_attribute(assume)
+#define EXPECTION_ASSUME(...) [[assume(__VA_ARGS__)]]
+#elif defined(__clang__)
+#define EXPECTION_ASSUME(...) __builtin_assume(__VA_ARGS__)
+#elif defined(_MSC_VER)
+#define EXPECTION_ASSUME(...) __assume(__VA_ARGS__)
+#else
+#define EXPECTION_ASSUME(...) ((__VA_ARGS__) ? void(0) : std::unreachable())
+#endif
+
+// Marks a function as an out-of-line, rarely executed path
+#if defined(__GNUC__) || defined(__clang__)
+#define EXPECTION_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define EXPECTION_COLD __declspec(noinline)
+#else
+#define EXPECTION_COLD
+#endif
+
+inline constexpr Policy DefaultPolicy = Policy::EXPECTION_DEFAULTPOLICY;
+
+// Per-function policies: EXPECTION_POLICY_FOR(function) is the policy that the
+// header named by EXPECTION_SELECTED_POLICIES selects for function, with a
+// line of EXPECTION_SELECT(function, Policy), and DefaultPolicy otherwise, e.g.
+//   template <Policy P = EXPECTION_POLICY_FOR(parse_record)>
+//   auto parse_record(std::string_view) -> ResultType<Record, ParseError, P>;
+// cmake/PolicyProfile.cmake generates such headers from failure-rate profiles
+namespace detail {
+struct PolicySelection {
+  const char *function;
+  Policy policy;
+};
+
+inline constexpr PolicySelection policy_selections[] = {
+#ifdef EXPECTION_SELECTED_POLICIES
+#define EXPECTION_SELECT(function, policy) {#function, Policy::policy},
+#include EXPECTION_SELECTED_POLICIES
+#undef EXPECTION_SELECT
+#endif
+    {nullptr, DefaultPolicy},
+};
+
+consteval auto name_size(const char *name) -> std::size_t {
+  std::size_t size = 0;
+  while (name[size] != '\0') {
+    ++size;
+  }
+  return size;
+}
+
+// Whether selected is function, or a function of that name in a namespace
+consteval auto selects(const char *selected, const char *function) -> bool {
+  const auto selected_size = name_size(selected);
+  const auto size = name_size(function);
+  if (size > selected_size) {
+    return false;
+  }
+  const auto prefix = selected_size - size;
+  for (std::size_t i = 0; i < size; ++i) {
+    if (selected[prefix + i] != function[i]) {
+      return false;
+    }
+  }
+  return prefix == 0 || (prefix >= 2 && selected[prefix - 1] == ':' &&
+                         selected[prefix - 2] == ':');
+}
+
+// Not constexpr: calling it makes EXPECTION_POLICY_FOR(function) ill-formed
+// when function names selections in several namespaces. Qualify it
+inline void ambiguous_policy_selection() {}
+
+// The selection of exactly function, or else the only selection of a function
+// of that name in a namespace
+consteval auto selected_policy(const char *function) -> Policy {
+  auto policy = DefaultPolicy;
+  std::size_t found = 0;
+  for (const auto &selection : policy_selections) {
+    if (selection.function == nullptr ||
+        !selects(selection.function, function)) {
+      continue;
+    }
+    if (name_size(selection.function) == name_size(function)) {
+      return selection.policy;
+    }
+    policy = selection.policy;
+    ++found;
+  }
+  if (found > 1) {
+    ambiguous_policy_selection();
+  }
+  return policy;
+}
+} // namespace detail
+
+#define EXPECTION_POLICY_FOR(function)                                         \
+  ::Expection::detail::selected_policy(#function)
+
+// Whether failures are returned as values (std::expected or compact_expected)
+// under the policy
+template <Policy P>
+inline constexpr bool ReturnsExpected =
+    P == Policy::Expected || P == Policy::Dynamic || P == Policy::Compact ||
+    P == Policy::Boundary;
+
+namespace detail {
+// Constructs and throws the exception out-of-line, so that callers only keep
+// the branch and a call. The exception is constructed directly in the
+// exception object. Falls back to the abort handler if exceptions are disabled
+// for this translation unit
+template <typename Factory, typename... Args>
+[[noreturn]] EXPECTION_COLD constexpr void raise_cold(Factory &&factory,
+                                                      Args &&...args) {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  throw std::forward<Factory>(factory)(std::forward<Args>(args)...);
+#else
+  (void)factory;
+  ((void)args, ...);
+  EXPECTION_ABORT_HANDLER();
+#endif
+}
+
+// Rethrows a prebuilt exception out-of-line
+[[noreturn]] EXPECTION_COLD inline void
+rethrow_cold(const std::exception_ptr &exception) {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  std::rethrow_exception(exception);
+#else
+  (void)exception;
+  EXPECTION_ABORT_HANDLER();
+#endif
+}
+
+// Exception factories, independent of the result type so that a single
+// raise_cold instantiation is shared by every function failing the same way
+template <typename T> struct StaticException {
+  template <typename... Args> auto operator()(Args &&...args) const {
+    return T::exception(std::forward<Args>(args)...);
+  }
+};
+
+struct ConvertedException {
+  template <typename T> auto operator()(T &error) const {
+    return error.exception();
+  }
+};
+
+// Failure path of the policies that neither throw nor return an error
+template <Policy P> [[noreturn]] inline void abandon() {
+#ifdef NDEBUG
+  if constexpr (P == Policy::Unchecked) {
+    std::unreachable();
+  }
+#endif
+  EXPECTION_ABORT_HANDLER();
+}
+
+// Message of a failure for compile-time diagnostics: Error::err_to_str() of
+// its arguments, of the first one, or of the Error's kind, or the err_to_str()
+// found through ADL (e.g. for enums)
+template <typename Error, typename First, typename... Rest>
+constexpr auto error_message(const First &first, const Rest &...rest)
+    -> const char * {
+  if constexpr (requires { Error::err_to_str(first, rest...); }) {
+    return Error::err_to_str(first, rest...);
+  } else if constexpr (requires { Error::err_to_str(first); }) {
+    return Error::err_to_str(first);
+  } else if constexpr (requires { Error::err_to_str(first.kind); }) {
+    return Error::err_to_str(first.kind);
+  } else if constexpr (requires { err_to_str(first); }) {
+    return err_to_str(first);
+  } else {
+    return "failure of an Error without err_to_str()";
+  }
+}
+
+template <typename Error> constexpr auto error_message() -> const char * {
+  return "failure of an Error without err_to_str()";
+}
+
+// Never a constant expression: a failure reached during constant evaluation
+// under a policy that can't return it stops compilation here. Compilers that
+// show argument values in their trace (e.g. Clang) print the message
+inline void failure_during_constant_evaluation(const char *) {}
+
+constexpr void failed_at_compile_time(const char *message) {
+  if (message != nullptr) {
+    failure_during_constant_evaluation(message);
+  }
+}
+
+} // namespace detail
+
+#ifdef EXPECTION_CIRCUIT_BREAKER
+namespace breaker {
+template <typename Error> void record_failure();
+} // namespace breaker
+#endif
+
+namespace detail {
+// Counts a success into the profile, if any. Skipped like on_failure()
+template <Policy P>
+constexpr void on_success([[maybe_unused]] const std::source_location &where) {
+#ifdef EXPECTION_PROFILE
+  if constexpr (P != Policy::Unchecked) {
+    if !consteval {
+      ::Expection::profile::record_success(where);
+    }
+  }
+#endif
+}
+
+// Calls the failure hook, sampler, circuit breaker and profile, if any.
+// Skipped during constant evaluation, and under Policy::Unchecked so that its
+// failure path can still be optimized away
+template <typename Error, Policy P, typename... Args>
+constexpr void on_failure([[maybe_unused]] const std::source_location &where,
+                          [[maybe_unused]] const Args &...args) {
+  if constexpr (!ReturnsExpected<P>) {
+    if consteval {
+      failed_at_compile_time(error_message<Error>(args...));
+    }
+  }
+  if constexpr (P != Policy::Unchecked) {
+    if !consteval {
+#ifdef EXPECTION_ON_FAILURE
+      EXPECTION_ON_FAILURE<Error>(args...);
+#endif
+#ifdef EXPECTION_SAMPLE_FAILURES
+      ::Expection::sampling::sample_failure(where);
+#endif
+#ifdef EXPECTION_CIRCUIT_BREAKER
+      ::Expection::breaker::record_failure<Error>();
+#endif
+#ifdef EXPECTION_PROFILE
+      ::Expection::profile::record_failure(where);
+#endif
+    }
+  }
+}
+} // namespace detail
+
+// === Compact Results ===
+
+// Spare values of T, which a valid T never holds, and that compact_expected
+// uses to store errors instead of a separate discriminant. Specializations
+// provide:
+//   static constexpr std::size_t count;           number of spare values
+//   static constexpr T spare(std::size_t index);  the index-th (< count) one
+//   static constexpr std::size_t index(const T &); index of a spare value, or
+//                                                  count for a valid T
+template <typename T> struct niche {};
+
+// Reserves Count values of an integral or enum type, from First upwards, e.g.
+// template <> struct Expection::niche<UserId>
+//     : Expection::reserved_values<UserId, UserId{0xffffff00}, 256> {};
+template <typename T, T First, std::size_t Count>
+  requires std::is_integral_v<T> || std::is_enum_v<T>
+struct reserved_values {
+private:
+  using Bits = std::make_unsigned_t<
+      typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>,
+                                  std::type_identity<T>>::type>;
+
+public:
+  static constexpr std::size_t count = Count;
+
+  static constexpr auto spare(std::size_t index) -> T {
+    return static_cast<T>(static_cast<Bits>(static_cast<Bits>(First) + index));
+  }
+
+  static constexpr auto index(const T &value) -> std::size_t {
+    const auto offset =
+        static_cast<Bits>(static_cast<Bits>(value) - static_cast<Bits>(First));
+    return offset < Count ? offset : Count;
+  }
+};
+
+// Object pointers: addresses in the first page, other than null (which stays a
+// valid result), never point to an object on the supported platforms
+template <typename T>
+  requires std::is_object_v<T>
+struct niche<T *> {
+  static constexpr std::size_t count = 4095;
+
+  static auto spare(std::size_t index) -> T * {
+    return reinterpret_cast<T *>(index + 1);
+  }
+
+  static auto index(T *const &value) -> std::size_t {
+    const auto address = reinterpret_cast<std::uintptr_t>(value);
+    return address - 1 < count ? address - 1 : count;
+  }
+};
+
+// Errors that can be encoded as the index of a spare value: provides
+// static index(const E &) -> std::size_t and static error(std::size_t) -> E
+template <typename E> struct niche_error {};
+
+template <typename E>
+  requires std::is_enum_v<E>
+struct niche_error<E> {
+  static constexpr auto index(const E &error) -> std::size_t {
+    return static_cast<std::size_t>(error);
+  }
+
+  static constexpr auto error(std::size_t index) -> E {
+    return static_cast<E>(index);
+  }
+};
+
+template <typename R, typename E>
+concept NicheStorable =
+    std::is_trivially_copyable_v<R> && std::is_trivially_copyable_v<E> &&
+    requires(const R &value, const E &error, std::size_t index) {
+      { niche<R>::count } -> std::convertible_to<std::size_t>;
+      { niche<R>::spare(index) } -> std::same_as<R>;
+      { niche<R>::index(value) } -> std::same_as<std::size_t>;
+      { niche_error<E>::index(error) } -> std::same_as<std::size_t>;
+      { niche_error<E>::error(index) } -> std::same_as<E>;
+    };
+
+namespace detail {
+// A result stored as a single R: spare values of R hold errors. Same interface
+// as std::expected, except that error() returns the error by value
+template <typename R, typename E> class NicheExpected {
+  using Niche = niche<R>;
+  using Codes = niche_error<E>;
+
+  R storage_;
+
+  static constexpr auto encode(const E &error) -> R {
+    const auto index = Codes::index(error);
+    if (index >= Niche::count) [[unlikely]] {
+      // More errors than spare values of R
+      EXPECTION_ABORT_HANDLER();
+    }
+    return Niche::spare(index);
+  }
+
+public:
+  using value_type = R;
+  using error_type = E;
+  using unexpected_type = std::unexpected<E>;
+
+  // The value must not be one of R's spare values
+  constexpr NicheExpected(const R &value) : storage_(value) {
+#ifndef NDEBUG
+    if (Niche::index(storage_) != Niche::count) {
+      EXPECTION_ABORT_HANDLER();
+    }
+#endif
+  }
+
+  template <typename... Args>
+    requires std::constructible_from<R, Args &&...>
+  constexpr explicit NicheExpected(std::in_place_t, Args &&...args)
+      : NicheExpected(R(std::forward<Args>(args)...)) {}
+
+  template <typename G>
+    requires std::constructible_from<E, const G &>
+  constexpr NicheExpected(const std::unexpected<G> &error)
+      : storage_(encode(E(error.error()))) {}
+
+  template <typename... Args>
+    requires std::constructible_from<E, Args &&...>
+  constexpr explicit NicheExpected(std::unexpect_t, Args &&...args)
+      : storage_(encode(E(std::forward<Args>(args)...))) {}
+
+  constexpr auto has_value() const -> bool {
+    return Niche::index(storage_) == Niche::count;
+  }
+
+  constexpr explicit operator bool() const { return has_value(); }
+
+  constexpr auto operator*() const & -> const R & { return storage_; }
+  constexpr auto operator*() & -> R & { return storage_; }
+  constexpr auto operator->() const -> const R * { return &storage_; }
+  constexpr auto operator->() -> R * { return &storage_; }
+
+  constexpr auto error() const -> E {
+    return Codes::error(Niche::index(storage_));
+  }
+
+  constexpr auto value() const -> const R & {
+    if (!has_value()) [[unlikely]] {
+      raise_cold(
+          [](const E &error) { return std::bad_expected_access<E>(error); },
+          error());
+    }
+    return storage_;
+  }
+
+  template <typename U>
+  constexpr auto value_or(U &&fallback) const -> R {
+    return has_value() ? storage_ : static_cast<R>(std::forward<U>(fallback));
+  }
+
+  friend constexpr bool operator==(const NicheExpected &,
+                                   const NicheExpected &) = default;
+};
+} // namespace detail
+
+// Policy::Compact result: a single R when R has enough spare values for E (see
+// niche and niche_error), otherwise std::expected<R, E>
+template <typename R, typename E>
+using compact_expected =
+    std::conditional_t<NicheStorable<R, E>, detail::NicheExpected<R, E>,
+                       std::expected<R, E>>;
+
+// Default Error type, for results that never fail
+struct NoError {
+  friend constexpr bool operator==(NoError, NoError) = default;
+};
+
+// Meta-function to determine the Return Type
+template <typename R, typename E = NoError, Policy P = DefaultPolicy>
+using ResultType = std::conditional_t<
+    P == Policy::Compact, compact_expected<R, E>,
+    std::conditional_t<ReturnsExpected<P>, std::expected<R, E>, R>>;
+
+namespace detail {
+// Results holding either a value or an error
+template <typename T> inline constexpr bool is_expected = false;
+
+template <typename T, typename E>
+inline constexpr bool is_expected<std::expected<T, E>> = true;
+
+template <typename T, typename E>
+inline constexpr bool is_expected<NicheExpected<T, E>> = true;
+
+template <typename T>
+concept ExpectedResult = is_expected<std::remove_cvref_t<T>>;
+} // namespace detail
+
+// === Error Accumulation ===
+
+// Value returned in place of a result by failures under Policy::Accumulate:
+// quiet NaN for floating point types, value-initialized otherwise.
+// Specializable for other sentinels
+template <typename R> struct poisoned {
+  static constexpr auto value() -> R {
+    if constexpr (std::numeric_limits<R>::has_quiet_NaN) {
+      return std::numeric_limits<R>::quiet_NaN();
+    } else {
+      return R{};
+    }
+  }
+};
+
+// Defined in Expection.hpp
+template <typename E, std::size_t Inline = 8> class ErrorList;
+
+namespace detail {
+// The innermost live ErrorList<E> of each thread
+template <typename E> struct ActiveErrors {
+  static inline thread_local void *list = nullptr;
+  static inline thread_local void (*append)(void *, E &&) = nullptr;
+};
+} // namespace detail
+
+namespace detail {
+// Failure path of Policy::Accumulate
+template <typename R, typename E> auto accumulate(E &&error) -> R {
+  using Error = std::decay_t<E>;
+  if (ActiveErrors<Error>::list == nullptr) [[unlikely]] {
+    // No ErrorList<E> to collect the error
+    EXPECTION_ABORT_HANDLER();
+  }
+  ActiveErrors<Error>::append(ActiveErrors<Error>::list,
+                              Error(std::forward<E>(error)));
+  if constexpr (!std::is_void_v<R>) {
+    return poisoned<R>::value();
+  }
+}
+} // namespace detail
+
+// === Success Helpers ===
+namespace detail {
+// Placeholder default for success()'s result type: when left unspecified, the
+// result type is deduced from the argument
+struct DeduceResult {};
+
+template <typename R, typename V>
+using SuccessResult =
+    std::conditional_t<std::is_same_v<R, DeduceResult>, std::remove_cvref_t<V>,
+                       R>;
+} // namespace detail
+
+// Forwards the value into the result, so rvalues (and move-only types) are
+// moved exactly once and lvalues copied exactly once. `where` is the success
+// site counted by profiles
+template <typename R = detail::DeduceResult, typename E = NoError,
+          Policy P = DefaultPolicy, typename V>
+  requires std::constructible_from<detail::SuccessResult<R, V>, V &&>
+constexpr auto success(V &&val, const std::source_location &where =
+                                    std::source_location::current())
+    -> ResultType<detail::SuccessResult<R, V>, E, P> {
+  using Result = detail::SuccessResult<R, V>;
+  detail::on_success<P>(where);
+
+  if constexpr (!ReturnsExpected<P>) {
+    // Prvalue return: constructed directly in the caller's return slot
+    return static_cast<Result>(std::forward<V>(val));
+  } else {
+    // Construct the value in-place inside the result
+    return ResultType<Result, E, P>(std::in_place, std::forward<V>(val));
+  }
+}
+
+// Constructs the value in-place from its constructor arguments, without any
+// intermediate object to copy or move from. `where` is the success site
+// counted by profiles
+template <typename R, typename E = NoError, Policy P = DefaultPolicy,
+          typename... Args>
+  requires std::constructible_from<R, Args &&...>
+constexpr auto success_in_place_at(const std::source_location &where,
+                                   Args &&...args) -> ResultType<R, E, P> {
+  detail::on_success<P>(where);
+  if constexpr (!ReturnsExpected<P>) {
+    return R(std::forward<Args>(args)...);
+  } else {
+    return ResultType<R, E, P>(std::in_place, std::forward<Args>(args)...);
+  }
+}
+
+// As with make_failure(), overloaded for up to three arguments defaulting
+// `where` to the caller. Calls with more arguments are unlocated
+template <typename R, typename E = NoError, Policy P = DefaultPolicy>
+  requires std::constructible_from<R>
+constexpr auto success_in_place(const std::source_location &where =
+                                    std::source_location::current())
+    -> ResultType<R, E, P> {
+  return success_in_place_at<R, E, P>(where);
+}
+
+template <typename R, typename E = NoError, Policy P = DefaultPolicy,
+          typename A>
+  requires std::constructible_from<R, A &&>
+constexpr auto success_in_place(A &&a, const std::source_location &where =
+                                           std::source_location::current())
+    -> ResultType<R, E, P> {
+  return success_in_place_at<R, E, P>(where, std::forward<A>(a));
+}
+
+template <typename R, typename E = NoError, Policy P = DefaultPolicy,
+          typename A1, typename A2>
+  requires std::constructible_from<R, A1 &&, A2 &&>
+constexpr auto success_in_place(A1 &&a1, A2 &&a2,
+                                const std::source_location &where =
+                                    std::source_location::current())
+    -> ResultType<R, E, P> {
+  return success_in_place_at<R, E, P>(where, std::forward<A1>(a1),
+                                      std::forward<A2>(a2));
+}
+
+template <typename R, typename E = NoError, Policy P = DefaultPolicy,
+          typename A1, typename A2, typename A3>
+  requires std::constructible_from<R, A1 &&, A2 &&, A3 &&>
+constexpr auto success_in_place(A1 &&a1, A2 &&a2, A3 &&a3,
+                                const std::source_location &where =
+                                    std::source_location::current())
+    -> ResultType<R, E, P> {
+  return success_in_place_at<R, E, P>(
+      where, std::forward<A1>(a1), std::forward<A2>(a2), std::forward<A3>(a3));
+}
+
+template <typename R, typename E = NoError, Policy P = DefaultPolicy,
+          typename... Args>
+  requires(sizeof...(Args) > 3) && std::constructible_from<R, Args &&...>
+constexpr auto success_in_place(Args &&...args) -> ResultType<R, E, P> {
+  return success_in_place_at<R, E, P>(std::source_location{},
+                                      std::forward<Args>(args)...);
+}
+
+// Void specialization
+template <typename E = NoError, Policy P = DefaultPolicy>
+constexpr auto success(const std::source_location &where =
+                           std::source_location::current())
+    -> ResultType<void, E, P> {
+  detail::on_success<P>(where);
+  if constexpr (!ReturnsExpected<P>) {
+    return;
+  } else {
+    return ResultType<void, E, P>{};
+  }
+}
+
+// === Failure Helpers ===
+
+// "Functor" based helpers
+template <typename T, typename Unexpected, typename... Args>
+concept ErrorFunctor = requires(Args &&...args) {
+  {
+    T::exception(std::forward<Args>(args)...)
+  } -> std::derived_from<std::exception>;
+
+  {
+    T::unexpected(std::forward<Args>(args)...)
+  } -> std::same_as<std::unexpected<Unexpected>>;
+};
+
+// "Functor" based overload: it takes one functor as template parameter,
+// defining static exception() and unexpected() methods.
+// The make_failure_at() overloads take the failure site first, to attribute
+// the failure to the caller in samples and profiles, e.g.
+//   make_failure_at<R, E, P>(std::source_location::current(), args...)
+// A defaulted parameter can't follow a deduced pack, so make_failure() is
+// overloaded for up to three arguments, each defaulting `where` to its caller.
+// Calls with more arguments are reported without a location
+template <typename R, typename E, typename Functor, Policy P = DefaultPolicy,
+          typename... Args>
+  requires ErrorFunctor<Functor, E, Args...>
+constexpr auto make_failure_at(const std::source_location &where,
+                               Args &&...args) -> ResultType<R, E, P> {
+  detail::on_failure<E, P>(where, args...);
+  if constexpr (P == Policy::Exceptions) {
+    detail::raise_cold(detail::StaticException<Functor>{},
+                       std::forward<Args>(args)...);
+  } else if constexpr (ReturnsExpected<P>) {
+    return Functor::unexpected(std::forward<Args>(args)...);
+  } else if constexpr (P == Policy::Accumulate) {
+    return detail::accumulate<R>(
+        Functor::unexpected(std::forward<Args>(args)...).error());
+  } else {
+    detail::abandon<P>();
+  }
+}
+
+template <typename R, typename E, typename Functor, Policy P = DefaultPolicy>
+  requires ErrorFunctor<Functor, E>
+constexpr auto make_failure(const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<R, E, P> {
+  return make_failure_at<R, E, Functor, P>(where);
+}
+
+template <typename R, typename E, typename Functor, Policy P = DefaultPolicy,
+          typename A>
+  requires ErrorFunctor<Functor, E, A>
+constexpr auto make_failure(A &&a, const std::source_location &where =
+                                       std::source_location::current())
+    -> ResultType<R, E, P> {
+  return make_failure_at<R, E, Functor, P>(where, std::forward<A>(a));
+}
+
+template <typename R, typename E, typename Functor, Policy P = DefaultPolicy,
+          typename A1, typename A2>
+  requires ErrorFunctor<Functor, E, A1, A2>
+constexpr auto make_failure(A1 &&a1, A2 &&a2,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<R, E, P> {
+  return make_failure_at<R, E, Functor, P>(where, std::forward<A1>(a1),
+                                           std::forward<A2>(a2));
+}
+
+template <typename R, typename E, typename Functor, Policy P = DefaultPolicy,
+          typename A1, typename A2, typename A3>
+  requires ErrorFunctor<Functor, E, A1, A2, A3>
+constexpr auto make_failure(A1 &&a1, A2 &&a2, A3 &&a3,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<R, E, P> {
+  return make_failure_at<R, E, Functor, P>(
+      where, std::forward<A1>(a1), std::forward<A2>(a2), std::forward<A3>(a3));
+}
+
+template <typename R, typename E, typename Functor, Policy P = DefaultPolicy,
+          typename... Args>
+  requires(sizeof...(Args) > 3) && ErrorFunctor<Functor, E, Args...>
+constexpr auto make_failure(Args &&...args) -> ResultType<R, E, P> {
+  return make_failure_at<R, E, Functor, P>(std::source_location{},
+                                           std::forward<Args>(args)...);
+}
+
+// Callable based approach
+template <typename T, typename... Args>
+concept ExceptionCallable = requires(T &&t, Args &&...args) {
+  { t(std::forward<Args>(args)...) } -> std::derived_from<std::exception>;
+};
+
+template <typename T, typename Error, typename... Args>
+concept UnexpectedCallable = requires(T &&t, Args &&...args) {
+  { t(std::forward<Args>(args)...) } -> std::same_as<std::unexpected<Error>>;
+};
+
+// "Makes" a failure object by directly calling the appropriate callable with
+// arguments
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Unexpected, typename Exception, typename... Args>
+  requires UnexpectedCallable<Unexpected, Error, Args...> &&
+           ExceptionCallable<Exception, Args...>
+constexpr auto make_failure_at(const std::source_location &where,
+                               Unexpected &&unexpected, Exception &&exception,
+                               Args &&...args) -> ResultType<Result, Error, P> {
+  detail::on_failure<Error, P>(where, args...);
+  if constexpr (P == Policy::Exceptions) {
+    detail::raise_cold(std::forward<Exception>(exception),
+                       std::forward<Args>(args)...);
+  } else if constexpr (ReturnsExpected<P>) {
+    return unexpected(std::forward<Args>(args)...);
+  } else if constexpr (P == Policy::Accumulate) {
+    return detail::accumulate<Result>(
+        unexpected(std::forward<Args>(args)...).error());
+  } else {
+    detail::abandon<P>();
+  }
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Unexpected, typename Exception>
+  requires UnexpectedCallable<Unexpected, Error> && ExceptionCallable<Exception>
+constexpr auto make_failure(Unexpected &&unexpected, Exception &&exception,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(where,
+                                           std::forward<Unexpected>(unexpected),
+                                           std::forward<Exception>(exception));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Unexpected, typename Exception, typename A>
+  requires UnexpectedCallable<Unexpected, Error, A> &&
+           ExceptionCallable<Exception, A>
+constexpr auto make_failure(Unexpected &&unexpected, Exception &&exception,
+                            A &&a, const std::source_location &where =
+                                       std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(
+      where, std::forward<Unexpected>(unexpected),
+      std::forward<Exception>(exception), std::forward<A>(a));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Unexpected, typename Exception, typename A1, typename A2>
+  requires UnexpectedCallable<Unexpected, Error, A1, A2> &&
+           ExceptionCallable<Exception, A1, A2>
+constexpr auto make_failure(Unexpected &&unexpected, Exception &&exception,
+                            A1 &&a1, A2 &&a2,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(
+      where, std::forward<Unexpected>(unexpected),
+      std::forward<Exception>(exception), std::forward<A1>(a1),
+      std::forward<A2>(a2));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Unexpected, typename Exception, typename A1, typename A2,
+          typename A3>
+  requires UnexpectedCallable<Unexpected, Error, A1, A2, A3> &&
+           ExceptionCallable<Exception, A1, A2, A3>
+constexpr auto make_failure(Unexpected &&unexpected, Exception &&exception,
+                            A1 &&a1, A2 &&a2, A3 &&a3,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(
+      where, std::forward<Unexpected>(unexpected),
+      std::forward<Exception>(exception), std::forward<A1>(a1),
+      std::forward<A2>(a2), std::forward<A3>(a3));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename Unexpected, typename Exception, typename... Args>
+  requires(sizeof...(Args) > 3) &&
+           UnexpectedCallable<Unexpected, Error, Args...> &&
+           ExceptionCallable<Exception, Args...>
+constexpr auto make_failure(Unexpected &&unexpected, Exception &&exception,
+                            Args &&...args) -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(
+      std::source_location{}, std::forward<Unexpected>(unexpected),
+      std::forward<Exception>(exception), std::forward<Args>(args)...);
+}
+
+// Static constructor based approach
+template <typename T, typename... Args>
+concept ExceptionConstructable = requires(Args &&...args) {
+  {
+    T::exception(std::forward<Args>(args)...)
+  } -> std::derived_from<std::exception>;
+};
+
+// Preallocated approach: the Error type hands out a prebuilt exception, which
+// is rethrown as-is instead of constructing a new one on every failure
+template <typename T, typename... Args>
+concept ExceptionPreallocated = requires(Args &&...args) {
+  {
+    T::exception_ptr(std::forward<Args>(args)...)
+  } -> std::convertible_to<const std::exception_ptr &>;
+};
+
+namespace detail {
+template <typename Error, typename... Args>
+concept InPlaceFailure = ExceptionConstructable<Error, Args...> ||
+                         ExceptionPreallocated<Error, Args...>;
+
+// Fixed-size table, without <array>
+template <typename T, std::size_t Count> struct Table {
+  T items[Count];
+};
+} // namespace detail
+
+// Builds one immutable Exception per enumerator of Enum on first use, from a
+// compile-time table of ToString(kind) messages. Enum's values must be
+// 0...Count-1, others call EXPECTION_ABORT_HANDLER. Meant to implement
+// Error::exception_ptr(kind)
+template <typename Exception, auto ToString, std::size_t Count, typename Enum>
+  requires std::is_enum_v<Enum> &&
+           std::constructible_from<Exception, decltype(ToString(Enum{}))>
+auto preallocated_exception(Enum kind) -> const std::exception_ptr & {
+  static constexpr auto messages = [] {
+    detail::Table<decltype(ToString(Enum{})), Count> table{};
+    for (std::size_t i = 0; i < Count; ++i) {
+      table.items[i] = ToString(static_cast<Enum>(i));
+    }
+    return table;
+  }();
+
+  static const auto exceptions = [] {
+    detail::Table<std::exception_ptr, Count> table;
+    for (std::size_t i = 0; i < Count; ++i) {
+      table.items[i] = std::make_exception_ptr(Exception(messages.items[i]));
+    }
+    return table;
+  }();
+
+  const auto index = static_cast<std::size_t>(kind);
+  if (index >= Count) [[unlikely]] {
+    EXPECTION_ABORT_HANDLER();
+  }
+  return exceptions.items[index];
+}
+
+// "Makes" a failure object by directly calling a constructor with arguments.
+// If Error provides a prebuilt exception_ptr(), it is preferred over
+// constructing a new exception()
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename... Args>
+  requires detail::InPlaceFailure<Error, Args...>
+constexpr auto make_failure_at(const std::source_location &where,
+                               Args &&...args) -> ResultType<Result, Error, P> {
+  detail::on_failure<Error, P>(where, args...);
+  if constexpr (P == Policy::Exceptions) {
+    if constexpr (ExceptionPreallocated<Error, Args...>) {
+      detail::rethrow_cold(Error::exception_ptr(std::forward<Args>(args)...));
+    } else {
+      detail::raise_cold(detail::StaticException<Error>{},
+                         std::forward<Args>(args)...);
+    }
+  } else if constexpr (ReturnsExpected<P>) {
+    return std::unexpected(Error{std::forward<Args>(args)...});
+  } else if constexpr (P == Policy::Accumulate) {
+    return detail::accumulate<Result>(Error{std::forward<Args>(args)...});
+  } else {
+    detail::abandon<P>();
+  }
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy>
+  requires detail::InPlaceFailure<Error>
+constexpr auto make_failure(const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(where);
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy, typename A>
+  requires detail::InPlaceFailure<Error, A>
+constexpr auto make_failure(A &&a, const std::source_location &where =
+                                       std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(where, std::forward<A>(a));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename A1, typename A2>
+  requires detail::InPlaceFailure<Error, A1, A2>
+constexpr auto make_failure(A1 &&a1, A2 &&a2,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(where, std::forward<A1>(a1),
+                                           std::forward<A2>(a2));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename A1, typename A2, typename A3>
+  requires detail::InPlaceFailure<Error, A1, A2, A3>
+constexpr auto make_failure(A1 &&a1, A2 &&a2, A3 &&a3,
+                            const std::source_location &where =
+                                std::source_location::current())
+    -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(
+      where, std::forward<A1>(a1), std::forward<A2>(a2), std::forward<A3>(a3));
+}
+
+template <typename Result, typename Error, Policy P = DefaultPolicy,
+          typename... Args>
+  requires(sizeof...(Args) > 3) && detail::InPlaceFailure<Error, Args...>
+constexpr auto make_failure(Args &&...args) -> ResultType<Result, Error, P> {
+  return make_failure_at<Result, Error, P>(std::source_location{},
+                                           std::forward<Args>(args)...);
+}
+
+// Conversion based approach
+template <typename T>
+concept ExceptionConvertible = requires(T &&t) {
+  { t.exception() } -> std::derived_from<std::exception>;
+};
+
+// Kind-keyed approach: an Error without a conversion, whose static exception()
+// builds the exception of its kind
+template <typename T>
+concept ExceptionFromKind = requires(T &&t) {
+  {
+    std::remove_cvref_t<T>::exception(t.kind)
+  } -> std::derived_from<std::exception>;
+};
+
+// Prebuilt approach: an Error object handing out the exception of its kind,
+// rethrown as-is (e.g. MappedError)
+template <typename T>
+concept ExceptionPtrConvertible = requires(T &&t) {
+  { t.exception_ptr() } -> std::convertible_to<const std::exception_ptr &>;
+};
+
+namespace detail {
+// failure() without the hook, for errors that were already reported. Errors
+// handing out a prebuilt exception_ptr() rethrow it instead of converting, and
+// those without a conversion throw Error::exception(error.kind)
+template <typename Result, Policy P, typename E>
+constexpr auto convert_failure(E &&error)
+    -> ResultType<Result, std::decay_t<E>, P> {
+  if constexpr (P == Policy::Exceptions) {
+    if constexpr (ExceptionPtrConvertible<E>) {
+      rethrow_cold(error.exception_ptr());
+    } else if constexpr (ExceptionConvertible<E>) {
+      raise_cold(ConvertedException{}, error);
+    } else {
+      raise_cold(StaticException<std::decay_t<E>>{}, error.kind);
+    }
+  } else if constexpr (ReturnsExpected<P>) {
+    return std::unexpected<std::decay_t<E>>(std::forward<E>(error));
+  } else if constexpr (P == Policy::Accumulate) {
+    return accumulate<Result>(std::forward<E>(error));
+  } else {
+    abandon<P>();
+  }
+}
+} // namespace detail
+
+// This one doesn't "make" a failure, it accepts an existing "Error" object with
+// a .exception() conversion. `where` is the failure site reported to sampling
+template <typename Result, Policy P = DefaultPolicy, ExceptionConvertible E>
+constexpr auto failure(E &&error, const std::source_location &where =
+                                      std::source_location::current())
+    -> ResultType<Result, std::decay_t<E>, P> {
+  detail::on_failure<std::decay_t<E>, P>(where, error);
+  return detail::convert_failure<Result, P>(std::forward<E>(error));
+}
+
+// === Lightweight Exceptions ===
+// light_exception<E>: an exception holding a copy of a trivially copyable
+// Error, and nothing else. Throwing it copies sizeof(E) bytes into the
+// exception object, without std::runtime_error's reference-counted string.
+// what() is looked up when called, from the Error's static messages (see
+// err_to_str). Meant as the result of Error::exception(), e.g.
+//   auto exception() const { return Expection::light_exception(*this); }
+
+template <typename E>
+  requires std::is_trivially_copyable_v<E>
+class light_exception : public std::exception {
+public:
+  explicit light_exception(const E &error) noexcept : error_(error) {}
+
+  auto what() const noexcept -> const char * override {
+    return detail::error_message<E>(error_);
+  }
+
+  auto error() const noexcept -> const E & { return error_; }
+
+private:
+  E error_;
+};
+
+// === Accessors ===
+// unwrap<P>(result), value_or<P>(result, fallback), unwrap_unchecked<P>(result)
+// Policy-generic access to the value of a ResultType<..., P>. Under the
+// policies returning R, the result already is the value and is passed through.
+// Under the others, they read the value without std::expected::value()'s
+// bad_expected_access path: unwrap calls EXPECTION_ABORT_HANDLER out-of-line
+// on failure, and unwrap_unchecked assumes success.
+// Lvalue results give references to their value, rvalues give the value
+
+namespace detail {
+template <typename T> struct UnwrappedType {
+  using type = std::conditional_t<std::is_lvalue_reference_v<T>, T,
+                                  std::remove_cvref_t<T>>;
+};
+
+template <typename T>
+  requires ExpectedResult<T>
+struct UnwrappedType<T> {
+  using Value = typename std::remove_cvref_t<T>::value_type;
+  using type = std::conditional_t<
+      std::is_void_v<Value>, void,
+      std::conditional_t<std::is_lvalue_reference_v<T>,
+                         decltype(*std::declval<T>()), Value>>;
+};
+
+template <typename T> using Unwrapped = typename UnwrappedType<T>::type;
+
+template <Policy P, typename T> constexpr void check_accessed() {
+  static_assert(ExpectedResult<T> == ReturnsExpected<P>,
+                "result type doesn't match the policy");
+}
+
+[[noreturn]] EXPECTION_COLD inline void unwrap_failed() {
+  EXPECTION_ABORT_HANDLER();
+}
+} // namespace detail
+
+template <Policy P = DefaultPolicy, typename T>
+constexpr auto unwrap(T &&result) -> detail::Unwrapped<T> {
+  detail::check_accessed<P, T>();
+  if constexpr (ReturnsExpected<P>) {
+    if (!result.has_value()) [[unlikely]] {
+      detail::unwrap_failed();
+    }
+    if constexpr (!std::is_void_v<detail::Unwrapped<T>>) {
+      return *std::forward<T>(result);
+    }
+  } else {
+    return std::forward<T>(result);
+  }
+}
+
+template <Policy P = DefaultPolicy, typename T>
+constexpr auto unwrap_unchecked(T &&result) -> detail::Unwrapped<T> {
+  detail::check_accessed<P, T>();
+  if constexpr (ReturnsExpected<P>) {
+    EXPECTION_ASSUME(result.has_value());
+    if constexpr (!std::is_void_v<detail::Unwrapped<T>>) {
+      return *std::forward<T>(result);
+    }
+  } else {
+    return std::forward<T>(result);
+  }
+}
+
+// The fallback is only evaluated (converted) under the policies returning
+// errors
+template <Policy P = DefaultPolicy, typename T, typename U>
+constexpr auto value_or(T &&result, U &&fallback)
+    -> std::remove_cvref_t<detail::Unwrapped<T>> {
+  detail::check_accessed<P, T>();
+  if constexpr (ReturnsExpected<P>) {
+    using Value = std::remove_cvref_t<detail::Unwrapped<T>>;
+    return result.has_value() ? Value(*std::forward<T>(result))
+                              : static_cast<Value>(std::forward<U>(fallback));
+  } else {
+    (void)fallback;
+    return std::forward<T>(result);
+  }
+}
+} // namespace Expection
+
+#ifdef EXPECTION_CIRCUIT_BREAKER
+#include "circuit_breaker.hpp"
+#endif
+
+#endif // ifndef EXPECTION_CORE_HPP
@@ -0,0 +1,149 @@
+#pragma once
+#ifndef EXPECTION_EQUIVALENCE_HPP
+#define EXPECTION_EQUIVALENCE_HPP
+
+#include <concepts>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#include "../Expection.hpp"
+
+namespace Expection {
+
+// === Policy Equivalence ===
+// policy_mismatch(f, args...) calls f.template operator()<P>(args...) under
+// Policy::Exceptions, Expected and Compact, and checks that they agree: equal
+// success values (NaN equal to NaN), or failures under each of them, with
+// equal Errors (their kind, if they have no operator==) and, for Errors that
+// convert to exceptions, the exception thrown under Exceptions of the same
+// type and message as the one failure() makes of the Expected error. Returns
+// nullptr when they agree, and a description of the first disagreement
+// otherwise. f wraps a policy-templated function, e.g.
+//
+//   policy_mismatch([]<Policy P>(int a, int b) { return divide_by<P>(a, b); },
+//                   1, 0);
+//
+// Meant for tests and fuzzers: requires exceptions
+
+namespace detail {
+template <typename T>
+constexpr auto same_value(const T &first, const T &second) -> bool {
+  if constexpr (std::is_floating_point_v<T>) {
+    return first == second || (first != first && second != second);
+  } else {
+    return first == second;
+  }
+}
+
+template <typename E>
+constexpr auto same_error(const E &first, const E &second) -> bool {
+  if constexpr (std::equality_comparable<E>) {
+    return first == second;
+  } else if constexpr (requires { first.kind == second.kind; }) {
+    return first.kind == second.kind;
+  } else {
+    return true;
+  }
+}
+
+// The exception failure() throws for error under Policy::Exceptions, or
+// nullptr for Errors without a conversion
+template <typename E> auto converted_exception(E error) -> std::exception_ptr {
+  if constexpr (ExceptionConvertible<E> || requires {
+                  { error.exception_ptr() } -> std::convertible_to<
+                                                std::exception_ptr>;
+                }) {
+    try {
+      convert_failure<void, Policy::Exceptions>(error);
+    } catch (...) {
+      return std::current_exception();
+    }
+  }
+  return nullptr;
+}
+
+// Same dynamic type, and same what() for std::exceptions
+inline auto same_exception(const std::exception_ptr &first,
+                           const std::exception_ptr &second) -> bool {
+  try {
+    std::rethrow_exception(first);
+  } catch (const std::exception &thrown) {
+    try {
+      std::rethrow_exception(second);
+    } catch (const std::exception &converted) {
+      return typeid(thrown) == typeid(converted) &&
+             std::strcmp(thrown.what(), converted.what()) == 0;
+    } catch (...) {
+      return false;
+    }
+  } catch (...) {
+    try {
+      std::rethrow_exception(second);
+    } catch (const std::exception &) {
+      return false;
+    } catch (...) {
+      return true;
+    }
+  }
+}
+} // namespace detail
+
+template <typename F, typename... Args>
+auto policy_mismatch(const F &f, const Args &...args) -> const char * {
+  using Value =
+      decltype(f.template operator()<Policy::Exceptions>(args...));
+
+  auto expected = f.template operator()<Policy::Expected>(args...);
+  auto compact = f.template operator()<Policy::Compact>(args...);
+
+  std::optional<std::conditional_t<std::is_void_v<Value>, NoError, Value>>
+      value;
+  std::exception_ptr thrown;
+  try {
+    if constexpr (std::is_void_v<Value>) {
+      f.template operator()<Policy::Exceptions>(args...);
+    } else {
+      value.emplace(f.template operator()<Policy::Exceptions>(args...));
+    }
+  } catch (...) {
+    thrown = std::current_exception();
+  }
+
+  if (compact.has_value() != expected.has_value()) {
+    return "Compact and Expected disagree on failing";
+  }
+  if (expected.has_value()) {
+    if (thrown) {
+      return "Exceptions threw where Expected succeeded";
+    }
+    if constexpr (!std::is_void_v<Value>) {
+      if (!detail::same_value<Value>(*value, *expected)) {
+        return "Exceptions and Expected returned different values";
+      }
+      if (!detail::same_value<Value>(*compact, *expected)) {
+        return "Compact and Expected returned different values";
+      }
+    }
+    return nullptr;
+  }
+
+  if (!thrown) {
+    return "Exceptions succeeded where Expected failed";
+  }
+  if (!detail::same_error(compact.error(), expected.error())) {
+    return "Compact and Expected failed with different errors";
+  }
+  auto converted = detail::converted_exception(expected.error());
+  if (converted && !detail::same_exception(thrown, converted)) {
+    return "Exceptions threw another exception than Expected's error converts "
+           "to";
+  }
+  return nullptr;
+}
+} // namespace Expection
+
+#endif // ifndef EXPECTION_EQUIVALENCE_HPP
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef EXPECTION_ERROR_MAP_HPP
+#define EXPECTION_ERROR_MAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../Expection.hpp"
+
+namespace Expection {
+
+// === Error Maps ===
+// A constexpr table describing, for every enumerator of Enum, its message, the
+// type of its exception and (optionally) the enumerator of a Foreign enum it
+// translates to at layer boundaries:
+//
+//   constexpr auto divide_errors = make_error_map<Kind, ServiceErrc>({
+//       {Kind::DivideByZero, "Division by Zero", ServiceErrc::InvalidArgument,
+//        exception_as<std::domain_error>},
+//   });
+//
+// Entries are placed by enumerator into dense arrays when the map is built, so
+// every lookup is an index. Enum's values must be 0...Count-1, each described
+// once (checked at compile time). MappedError<Map> is an Error type built on
+// a map, and translate<ForeignError, P>(map, result) converts failed results
+
+// Exception factory of an ErrorMap entry
+using ExceptionFactory = std::exception_ptr (*)(const char *message);
+
+template <typename Exception>
+  requires std::constructible_from<Exception, const char *>
+auto exception_as(const char *message) -> std::exception_ptr {
+  return std::make_exception_ptr(Exception(message));
+}
+
+namespace detail {
+// Foreign enum of maps without translation
+struct NoForeign {};
+} // namespace detail
+
+template <typename Enum, typename Foreign = void> struct ErrorMapEntry {
+  using ForeignKind =
+      std::conditional_t<std::is_void_v<Foreign>, detail::NoForeign, Foreign>;
+
+  Enum kind;
+  const char *message;
+  ForeignKind foreign{};
+  ExceptionFactory exception = &exception_as<std::runtime_error>;
+};
+
+template <typename Enum, typename Foreign, std::size_t Count>
+  requires std::is_enum_v<Enum>
+class ErrorMap {
+public:
+  using Kind = Enum;
+  using ForeignKind = typename ErrorMapEntry<Enum, Foreign>::ForeignKind;
+  static constexpr std::size_t size = Count;
+
+  consteval ErrorMap(const ErrorMapEntry<Enum, Foreign> (&entries)[Count]) {
+    std::array<bool, Count> described{};
+    for (const auto &entry : entries) {
+      const auto index = static_cast<std::size_t>(entry.kind);
+      if (index >= Count || described[index]) {
+        detail::failed_at_compile_time(
+            "ErrorMap enumerators must be 0...Count-1, each described once");
+      }
+      described[index] = true;
+      messages_[index] = entry.message;
+      foreign_[index] = entry.foreign;
+      exceptions_[index] = entry.exception;
+    }
+  }
+
+  constexpr auto message(Kind kind) const -> const char * {
+    return messages_[index(kind)];
+  }
+
+  constexpr auto translate(Kind kind) const -> ForeignKind
+    requires(!std::is_void_v<Foreign>)
+  {
+    return foreign_[index(kind)];
+  }
+
+  // A new exception of the kind's type, holding its message
+  auto exception_ptr(Kind kind) const -> std::exception_ptr {
+    return exceptions_[index(kind)](message(kind));
+  }
+
+private:
+  static constexpr auto index(Kind kind) -> std::size_t {
+    return static_cast<std::size_t>(kind);
+  }
+
+  std::array<const char *, Count> messages_{};
+  std::array<ForeignKind, Count> foreign_{};
+  std::array<ExceptionFactory, Count> exceptions_{};
+};
+
+template <typename Enum, typename Foreign = void, std::size_t Count>
+consteval auto
+make_error_map(const ErrorMapEntry<Enum, Foreign> (&entries)[Count])
+    -> ErrorMap<Enum, Foreign, Count> {
+  return ErrorMap<Enum, Foreign, Count>(entries);
+}
+
+// Error type described by an ErrorMap (a constexpr variable with static
+// storage duration). Under Policy::Exceptions, make_failure and failure
+// rethrow one exception per kind, built on first use. Kinds outside the map
+// call EXPECTION_ABORT_HANDLER
+template <const auto &Map> struct MappedError {
+  using Kind = typename std::remove_cvref_t<decltype(Map)>::Kind;
+
+  Kind kind;
+
+  static constexpr auto err_to_str(Kind kind) -> const char * {
+    return Map.message(kind);
+  }
+
+  constexpr auto str() const -> const char * { return Map.message(kind); }
+
+  static auto exception_ptr(Kind kind) -> const std::exception_ptr & {
+    static const auto exceptions = [] {
+      std::array<std::exception_ptr, std::remove_cvref_t<decltype(Map)>::size>
+          table;
+      for (std::size_t i = 0; i < table.size(); ++i) {
+        table[i] = Map.exception_ptr(static_cast<Kind>(i));
+      }
+      return table;
+    }();
+    const auto index = static_cast<std::size_t>(kind);
+    if (index >= exceptions.size()) [[unlikely]] {
+      EXPECTION_ABORT_HANDLER();
+    }
+    return exceptions[index];
+  }
+
+  auto exception_ptr() const -> const std::exception_ptr & {
+    return exception_ptr(kind);
+  }
+
+  // Convert to exception, losing the kind's exception type: failure() uses
+  // exception_ptr() instead
+  auto exception() const { return std::runtime_error(str()); }
+
+  friend constexpr bool operator==(const MappedError &,
+                                   const MappedError &) = default;
+};
+
+namespace detail {
+template <typename E> constexpr auto error_kind(const E &error) {
+  if constexpr (std::is_enum_v<E>) {
+    return error;
+  } else {
+    return error.kind;
+  }
+}
+} // namespace detail
+
+// Translates the Error of a failed result into ForeignError, constructed from
+// Map.translate(kind). The failure was already reported, so hooks aren't called
+// again. Under the policies returning R, the result is passed through: failures
+// were already thrown (or handled) under the original Error
+template <typename ForeignError, Policy P = DefaultPolicy, typename Map,
+          typename T>
+constexpr auto translate(const Map &map, T &&result) {
+  if constexpr (ReturnsExpected<P>) {
+    using Value = typename std::remove_cvref_t<T>::value_type;
+    using Result = ResultType<Value, ForeignError, P>;
+    if (!result.has_value()) [[unlikely]] {
+      return Result(std::unexpect,
+                    ForeignError(map.translate(detail::error_kind(
+                        std::forward<T>(result).error()))));
+    }
+    if constexpr (std::is_void_v<Value>) {
+      return Result();
+    } else {
+      return Result(std::in_place, *std::forward<T>(result));
+    }
+  } else {
+    return std::remove_cvref_t<T>(std::forward<T>(result));
+  }
+}
+} // namespace Expection
+
+#endif // ifndef EXPECTION_ERROR_MAP_HPP
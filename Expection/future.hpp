@@ -0,0 +1,129 @@
+#pragma once
+#ifndef EXPECTION_FUTURE_HPP
+#define EXPECTION_FUTURE_HPP
+
+#include <exception>
+#include <expected>
+#include <future>
+#include <type_traits>
+#include <utility>
+
+#include "../Expection.hpp"
+
+namespace Expection {
+
+// === Error Transport ===
+// Conversions between results, std::exception_ptr and promise/future pairs, so
+// that results cross threads (and policy boundaries) without a throw and catch
+// per task. Errors become exceptions as they would be thrown by failure(),
+// without the throw
+
+namespace detail {
+template <typename T> struct IsExceptionPtrError : std::false_type {};
+
+template <typename T>
+  requires std::is_same_v<typename T::error_type, std::exception_ptr>
+struct IsExceptionPtrError<T> : std::true_type {};
+} // namespace detail
+
+// Exception of an Error, without throwing it. As with failure(), a prebuilt
+// exception_ptr() is handed out as-is, and Errors without a conversion get
+// Error::exception(error.kind)
+template <typename E>
+  requires ExceptionPtrConvertible<E &> || ExceptionConvertible<E &> ||
+           ExceptionFromKind<E &>
+auto to_exception_ptr(E &&error) -> std::exception_ptr {
+  if constexpr (ExceptionPtrConvertible<E &>) {
+    return error.exception_ptr();
+  } else if constexpr (ExceptionConvertible<E &>) {
+    return std::make_exception_ptr(error.exception());
+  } else {
+    return std::make_exception_ptr(
+        std::remove_cvref_t<E>::exception(error.kind));
+  }
+}
+
+// Exception of a failed result, or a null exception_ptr on success
+template <typename T>
+  requires detail::ExpectedResult<T>
+auto to_exception_ptr(const T &result) -> std::exception_ptr {
+  if (result.has_value()) {
+    return nullptr;
+  }
+  if constexpr (detail::IsExceptionPtrError<T>::value) {
+    return result.error();
+  } else {
+    auto error = result.error();
+    return to_exception_ptr(error);
+  }
+}
+
+// Result of a failed task, with the exception_ptr itself as the Error: thrown
+// as-is under Policy::Exceptions
+template <typename R, Policy P = DefaultPolicy>
+auto from_exception_ptr(std::exception_ptr exception)
+    -> ResultType<R, std::exception_ptr, P> {
+  if constexpr (P == Policy::Exceptions) {
+    detail::rethrow_cold(exception);
+  } else if constexpr (ReturnsExpected<P>) {
+    return std::unexpected(std::move(exception));
+  } else if constexpr (P == Policy::Accumulate) {
+    return detail::accumulate<R>(std::move(exception));
+  } else {
+    detail::abandon<P>();
+  }
+}
+
+// Fulfils the promise with the value or the error of a result. Failures are
+// stored with set_exception() from to_exception_ptr(), without unwinding.
+// Under the policies returning R, the result is the value itself
+template <typename R, typename T>
+void set_result(std::promise<R> &promise, T &&result) {
+  if constexpr (detail::ExpectedResult<T>) {
+    if (!result.has_value()) [[unlikely]] {
+      promise.set_exception(to_exception_ptr(result));
+    } else if constexpr (std::is_void_v<R>) {
+      promise.set_value();
+    } else {
+      promise.set_value(*std::forward<T>(result));
+    }
+  } else {
+    promise.set_value(std::forward<T>(result));
+  }
+}
+
+// Waits for the future and returns its outcome under the given policy. Under
+// Policy::Exceptions, this is future.get(). Under the policies returning
+// errors, a stored exception becomes the Error (the only case where
+// Expection catches, since std::future exposes no other way to reach it)
+template <Policy P = DefaultPolicy, typename R>
+auto get_result(std::future<R> &future)
+    -> ResultType<R, std::exception_ptr, P> {
+  if constexpr (ReturnsExpected<P>) {
+    using Result = ResultType<R, std::exception_ptr, P>;
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+    try {
+      if constexpr (std::is_void_v<R>) {
+        future.get();
+        return Result();
+      } else {
+        return Result(std::in_place, future.get());
+      }
+    } catch (...) {
+      return from_exception_ptr<R, P>(std::current_exception());
+    }
+#else
+    if constexpr (std::is_void_v<R>) {
+      future.get();
+      return Result();
+    } else {
+      return Result(std::in_place, future.get());
+    }
+#endif
+  } else {
+    return future.get();
+  }
+}
+} // namespace Expection
+
+#endif // ifndef EXPECTION_FUTURE_HPP
@@ -0,0 +1,276 @@
+#pragma once
+#ifndef EXPECTION_PARALLEL_HPP
+#define EXPECTION_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../Expection.hpp"
+
+namespace Expection::parallel {
+
+// === Parallel Algorithms ===
+// for_each, transform and transform_reduce over random-access ranges, calling
+// a function that returns ResultType<..., E, P>. The range is split into one
+// contiguous chunk per thread (the calling thread takes the first one). The
+// first failure sets a shared flag that stops every chunk before its next
+// element, and is then propagated according to P: returned as the Error, or
+// rethrown on the calling thread once every worker has stopped (instead of
+// std::terminate, as with the standard parallel algorithms).
+// When several elements fail concurrently, the first one observed wins.
+// Under Policy::Accumulate, failures don't stop the run: each chunk collects
+// its own (ErrorLists are per thread), and they are appended to the calling
+// thread's ErrorList<E> in element order once every chunk stopped.
+// `threads` defaults to std::thread::hardware_concurrency()
+
+namespace detail {
+// The first failure of a parallel run, and the flag cancelling the others
+template <typename E, Policy P> struct FirstFailure {
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> claimed{false};
+  std::conditional_t<ReturnsExpected<P>, std::optional<E>, std::exception_ptr>
+      failure;
+
+  auto stopped() const -> bool {
+    return cancelled.load(std::memory_order_relaxed);
+  }
+
+  template <typename Failure> void fail(Failure &&reason) {
+    cancelled.store(true, std::memory_order_relaxed);
+    // Only the winner writes, and the result is read after joining
+    if (!claimed.exchange(true, std::memory_order_relaxed)) {
+      failure = std::forward<Failure>(reason);
+    }
+  }
+
+  template <typename R, typename Success>
+  auto result(Success &&make_success) -> ResultType<R, E, P> {
+    if constexpr (ReturnsExpected<P>) {
+      if (failure.has_value()) [[unlikely]] {
+        return ResultType<R, E, P>(std::unexpect, std::move(*failure));
+      }
+    } else if constexpr (P == Policy::Exceptions) {
+      if (failure != nullptr) [[unlikely]] {
+        ::Expection::detail::rethrow_cold(failure);
+      }
+    }
+    return std::forward<Success>(make_success)();
+  }
+};
+
+inline auto thread_count(std::size_t threads, std::size_t count)
+    -> std::size_t {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return std::max<std::size_t>(1, std::min(threads, count));
+}
+
+// Calls chunk(index, begin, end) for `threads` contiguous chunks of
+// [0, count), the first one on the calling thread, as are the chunks of
+// threads that couldn't be started. Exceptions escaping a chunk stop the
+// others: under Policy::Exceptions they are recorded as the failure, under
+// the other policies the first one is rethrown once every chunk stopped
+template <typename E, Policy P, typename Chunk>
+void run_chunks(std::size_t count, std::size_t threads,
+                FirstFailure<E, P> &failure, Chunk &chunk) {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  std::exception_ptr escaped;
+  std::atomic<bool> escape_claimed{false};
+#endif
+  auto guarded = [&](std::size_t index, std::size_t begin, std::size_t end) {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+    try {
+      chunk(index, begin, end);
+    } catch (...) {
+      if constexpr (P == Policy::Exceptions) {
+        failure.fail(std::current_exception());
+      } else {
+        failure.cancelled.store(true, std::memory_order_relaxed);
+        if (!escape_claimed.exchange(true, std::memory_order_relaxed)) {
+          escaped = std::current_exception();
+        }
+      }
+    }
+#else
+    chunk(index, begin, end);
+#endif
+  };
+
+  // Failures of each chunk under Policy::Accumulate
+  std::vector<std::vector<E>> accumulated(P == Policy::Accumulate ? threads
+                                                                  : 0);
+  auto collect = [&](std::size_t index, std::size_t begin, std::size_t end) {
+    if constexpr (P == Policy::Accumulate) {
+      ErrorList<E> errors;
+      guarded(index, begin, end);
+      accumulated[index].assign(errors.begin(), errors.end());
+    } else {
+      guarded(index, begin, end);
+    }
+  };
+
+  auto bound = [&](std::size_t index) { return count * index / threads; };
+
+  // Joined when destroyed, however this returns
+  std::vector<std::jthread> workers;
+  workers.reserve(threads - 1);
+  std::size_t started = 1;
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  try {
+#endif
+    for (; started < threads; ++started) {
+      workers.emplace_back(collect, started, bound(started),
+                           bound(started + 1));
+    }
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  } catch (const std::system_error &) {
+    // Out of threads: the remaining chunks run on this one
+  }
+#endif
+  collect(0, bound(0), bound(1));
+  for (auto index = started; index < threads; ++index) {
+    collect(index, bound(index), bound(index + 1));
+  }
+  workers.clear();
+
+  for (auto &errors : accumulated) {
+    for (auto &error : errors) {
+      ::Expection::detail::accumulate<void>(std::move(error));
+    }
+  }
+
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+  if (escaped != nullptr) [[unlikely]] {
+    std::rethrow_exception(escaped);
+  }
+#endif
+}
+
+// Calls f on an element, and passes its value to sink unless it failed
+template <typename E, Policy P, typename F, typename T, typename Sink>
+void apply(FirstFailure<E, P> &failure, F &f, T &&element, Sink &&sink) {
+  using Result = std::invoke_result_t<F &, T>;
+
+  if constexpr (::Expection::detail::ExpectedResult<Result>) {
+    auto result = std::invoke(f, std::forward<T>(element));
+    if (!result.has_value()) [[unlikely]] {
+      failure.fail(std::move(result).error());
+      return;
+    }
+    if constexpr (std::is_void_v<typename Result::value_type>) {
+      sink();
+    } else {
+      sink(*std::move(result));
+    }
+  } else if constexpr (std::is_void_v<Result>) {
+    std::invoke(f, std::forward<T>(element));
+    sink();
+  } else {
+    sink(std::invoke(f, std::forward<T>(element)));
+  }
+}
+} // namespace detail
+
+// Calls f(element) for every element
+template <typename E, Policy P = DefaultPolicy,
+          std::ranges::random_access_range Range, typename F>
+auto for_each(Range &&range, F f, std::size_t threads = 0)
+    -> ResultType<void, E, P> {
+  const auto count = static_cast<std::size_t>(std::ranges::size(range));
+  threads = detail::thread_count(threads, count);
+  auto first = std::ranges::begin(range);
+
+  detail::FirstFailure<E, P> failure;
+  auto chunk = [&](std::size_t, std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end && !failure.stopped(); ++i) {
+      detail::apply(failure, f, first[static_cast<std::ptrdiff_t>(i)],
+                    [](auto &&...) {});
+    }
+  };
+  detail::run_chunks(count, threads, failure, chunk);
+
+  return failure.template result<void>([] { return success<E, P>(); });
+}
+
+// Writes f(input[i]) to output[i], for every element of input. output must
+// be at least as long as input. On failure, output is partially written
+template <typename E, Policy P = DefaultPolicy,
+          std::ranges::random_access_range Input,
+          std::ranges::random_access_range Output, typename F>
+auto transform(Input &&input, Output &&output, F f, std::size_t threads = 0)
+    -> ResultType<void, E, P> {
+  const auto count = static_cast<std::size_t>(std::ranges::size(input));
+  threads = detail::thread_count(threads, count);
+  auto in = std::ranges::begin(input);
+  auto out = std::ranges::begin(output);
+
+  detail::FirstFailure<E, P> failure;
+  auto chunk = [&](std::size_t, std::size_t begin, std::size_t end) {
+    for (auto i = begin; i < end && !failure.stopped(); ++i) {
+      const auto at = static_cast<std::ptrdiff_t>(i);
+      detail::apply(failure, f, in[at], [&](auto &&value) {
+        out[at] = std::forward<decltype(value)>(value);
+      });
+    }
+  };
+  detail::run_chunks(count, threads, failure, chunk);
+
+  return failure.template result<void>([] { return success<E, P>(); });
+}
+
+// reduce(init, f(element)...) over every element, where reduce is associative.
+// Chunks are reduced locally, then combined in order
+template <typename E, Policy P = DefaultPolicy,
+          std::ranges::random_access_range Range, typename T, typename Reduce,
+          typename F>
+auto transform_reduce(Range &&range, T init, Reduce reduce, F f,
+                      std::size_t threads = 0) -> ResultType<T, E, P> {
+  const auto count = static_cast<std::size_t>(std::ranges::size(range));
+  threads = detail::thread_count(threads, count);
+  auto first = std::ranges::begin(range);
+
+  detail::FirstFailure<E, P> failure;
+  std::vector<std::optional<T>> partials(threads);
+  auto chunk = [&](std::size_t index, std::size_t begin, std::size_t end) {
+    // Reduced locally, and stored once, so that threads don't share lines
+    std::optional<T> partial;
+    for (auto i = begin; i < end && !failure.stopped(); ++i) {
+      detail::apply(failure, f, first[static_cast<std::ptrdiff_t>(i)],
+                    [&](auto &&value) {
+                      if (partial.has_value()) {
+                        partial = std::invoke(
+                            reduce, std::move(*partial),
+                            std::forward<decltype(value)>(value));
+                      } else {
+                        partial.emplace(std::forward<decltype(value)>(value));
+                      }
+                    });
+    }
+    partials[index] = std::move(partial);
+  };
+  detail::run_chunks(count, threads, failure, chunk);
+
+  return failure.template result<T>([&] {
+    for (auto &partial : partials) {
+      if (partial.has_value()) {
+        init = std::invoke(reduce, std::move(init), std::move(*partial));
+      }
+    }
+    return success<T, E, P>(std::move(init));
+  });
+}
+} // namespace Expection::parallel
+
+#endif // ifndef EXPECTION_PARALLEL_HPP
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef EXPECTION_PROFILE_HPP
+#define EXPECTION_PROFILE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <source_location>
+#include <string_view>
+
+// Failure-rate profiles: the success and failure helpers count their outcomes
+// per function, from their std::source_location. Those called with more than
+// three deduced arguments can't default one: their outcomes are counted apart,
+// as unlocated. At exit, the counts are written to the file named by the
+// EXPECTION_PROFILE_PATH environment variable, if set (or at any time with
+// save()), which cmake/PolicyProfile.cmake turns into the policy selections
+// of EXPECTION_POLICY_FOR. Enabled by defining EXPECTION_PROFILE before
+// including Expection.hpp (which then includes this header)
+
+// Number of distinct source_location function names counted, must be a power
+// of two. Later ones are counted as unlocated
+#ifndef EXPECTION_PROFILE_SITES
+#define EXPECTION_PROFILE_SITES 4096
+#endif
+
+namespace Expection::profile {
+
+inline constexpr std::size_t Sites = EXPECTION_PROFILE_SITES;
+
+static_assert(Sites != 0 && (Sites & (Sites - 1)) == 0,
+              "EXPECTION_PROFILE_SITES must be a power of two");
+
+namespace detail {
+struct Site {
+  std::atomic<const char *> function{nullptr};
+  std::atomic<std::uint64_t> successes{0};
+  std::atomic<std::uint64_t> failures{0};
+};
+
+// Open addressing on the address of the function name, which the locations
+// of a function (instantiation) share. Instantiations of a function template
+// are counted apart, and summed when the profile is read
+inline Site sites[Sites];
+inline Site unlocated;
+
+inline auto site(const char *function) -> Site & {
+  if (*function == '\0') {
+    return unlocated;
+  }
+  const auto hash = static_cast<std::size_t>(
+      (reinterpret_cast<std::uintptr_t>(function) >> 3) * 0x9e3779b97f4a7c15u);
+  for (std::size_t probe = 0; probe < Sites; ++probe) {
+    auto &slot = sites[(hash + probe) & (Sites - 1)];
+    auto *seen = slot.function.load(std::memory_order_acquire);
+    if (seen == nullptr &&
+        slot.function.compare_exchange_strong(seen, function,
+                                              std::memory_order_acq_rel)) {
+      return slot;
+    }
+    if (seen == function) {
+      return slot;
+    }
+  }
+  return unlocated;
+}
+} // namespace detail
+
+inline void record_success(const std::source_location &where) {
+  detail::site(where.function_name())
+      .successes.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void record_failure(const std::source_location &where) {
+  detail::site(where.function_name())
+      .failures.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The (qualified) name of the function in a source_location::function_name():
+// without its return type, parameters and template arguments, e.g.
+// "parse::record" for "auto parse::record(std::string_view) [with P = ...]"
+constexpr auto function_key(std::string_view name) -> std::string_view {
+  constexpr std::string_view anonymous = "(anonymous namespace)";
+  std::size_t depth = 0;
+  auto end = std::string_view::npos;
+  for (std::size_t i = 0; i < name.size() && end == std::string_view::npos;
+       ++i) {
+    if (name[i] == '<') {
+      ++depth;
+    } else if (name[i] == '>' && depth != 0) {
+      --depth;
+    } else if (name[i] == '(' && depth == 0) {
+      if (name.substr(i).starts_with(anonymous)) {
+        i += anonymous.size() - 1;
+      } else {
+        end = i;
+      }
+    }
+  }
+  if (end == std::string_view::npos) {
+    return name;
+  }
+
+  // Explicit template arguments (MSVC)
+  if (end != 0 && name[end - 1] == '>') {
+    depth = 0;
+    while (end != 0) {
+      const auto c = name[--end];
+      if (c == '>') {
+        ++depth;
+      } else if (c == '<' && --depth == 0) {
+        break;
+      }
+    }
+  }
+
+  auto begin = end;
+  depth = 0;
+  while (begin != 0) {
+    const auto c = name[begin - 1];
+    if (c == '>' || c == ')') {
+      ++depth;
+    } else if ((c == '<' || c == '(') && depth != 0) {
+      --depth;
+    } else if (c == ' ' && depth == 0) {
+      break;
+    }
+    --begin;
+  }
+  return name.substr(begin, end - begin);
+}
+
+// Visits f(function, successes, failures) for every counted function, then for
+// the unlocated outcomes (with an empty function)
+template <typename F> void for_each_site(F &&f) {
+  for (const auto &site : detail::sites) {
+    const auto *function = site.function.load(std::memory_order_acquire);
+    if (function != nullptr) {
+      f(function_key(function),
+        site.successes.load(std::memory_order_relaxed),
+        site.failures.load(std::memory_order_relaxed));
+    }
+  }
+  f(std::string_view(), detail::unlocated.successes.load(),
+    detail::unlocated.failures.load());
+}
+
+// Writes the profile, one "<successes> <failures> <function>" line per
+// function (unlocated outcomes are "-")
+inline void dump(std::FILE *file) {
+  std::fputs("# successes failures function\n", file);
+  for_each_site([file](std::string_view function, std::uint64_t successes,
+                       std::uint64_t failures) {
+    if (function.empty()) {
+      function = "-";
+    }
+    std::fprintf(file, "%llu %llu %.*s\n",
+                 static_cast<unsigned long long>(successes),
+                 static_cast<unsigned long long>(failures),
+                 static_cast<int>(function.size()), function.data());
+  });
+}
+
+inline auto save(const char *path) -> bool {
+  auto *file = std::fopen(path, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  dump(file);
+  return std::fclose(file) == 0;
+}
+
+namespace detail {
+// Only written when asked for, so that profiled programs don't leave files
+// behind in their working directory
+struct SaveAtExit {
+  ~SaveAtExit() {
+    if (const auto *path = std::getenv("EXPECTION_PROFILE_PATH")) {
+      save(path);
+    }
+  }
+};
+
+inline SaveAtExit save_at_exit;
+} // namespace detail
+} // namespace Expection::profile
+
+#endif // ifndef EXPECTION_PROFILE_HPP
@@ -0,0 +1,274 @@
+#pragma once
+#ifndef EXPECTION_SAMPLING_HPP
+#define EXPECTION_SAMPLING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <source_location>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+// Sampled failure sites: one failure in EXPECTION_SAMPLE_EVERY (per thread) is
+// recorded into a fixed-size, lock-free ring buffer, with its source location,
+// return address and a hash of the call stack. make_failure() with more than
+// three arguments has no location (make_failure_at() takes one): its samples
+// are only told apart by their return address. Enabled by defining
+// EXPECTION_SAMPLE_FAILURES before including Expection.hpp (which then
+// includes this header). Unsampled failures only decrement a thread-local
+// counter.
+// With EXPECTION_FRAME_POINTERS defined (the program must then be built with
+// -fno-omit-frame-pointer), the stack hash covers up to
+// EXPECTION_SAMPLE_STACK_DEPTH frames, otherwise only the failure site
+
+#ifndef EXPECTION_SAMPLE_EVERY
+#define EXPECTION_SAMPLE_EVERY 1024
+#endif
+
+// Number of samples kept, must be a power of two
+#ifndef EXPECTION_SAMPLE_RING_SIZE
+#define EXPECTION_SAMPLE_RING_SIZE 256
+#endif
+
+#ifndef EXPECTION_SAMPLE_STACK_DEPTH
+#define EXPECTION_SAMPLE_STACK_DEPTH 16
+#endif
+
+namespace Expection::sampling {
+
+inline constexpr std::size_t RingSize = EXPECTION_SAMPLE_RING_SIZE;
+inline constexpr std::size_t StackDepth = EXPECTION_SAMPLE_STACK_DEPTH;
+
+static_assert(RingSize != 0 && (RingSize & (RingSize - 1)) == 0,
+              "EXPECTION_SAMPLE_RING_SIZE must be a power of two");
+
+// A recorded failure. file and function are empty (and line is 0) for
+// failures made without a source location
+struct FailureSample {
+  std::uint64_t sequence;
+  const char *file;
+  const char *function;
+  std::uint_least32_t line;
+  std::uintptr_t return_address;
+  std::uint64_t stack_hash;
+};
+
+namespace detail {
+// Ring slot, guarded by a sequence number: odd while a writer fills it, and
+// 2 * (sample sequence + 1) once complete. Every field is a lock-free atomic,
+// so slots can be read from a signal handler
+struct Slot {
+  std::atomic<std::uint64_t> sequence{0};
+  std::atomic<const char *> file{nullptr};
+  std::atomic<const char *> function{nullptr};
+  std::atomic<std::uint_least32_t> line{0};
+  std::atomic<std::uintptr_t> return_address{0};
+  std::atomic<std::uint64_t> stack_hash{0};
+};
+
+inline Slot ring[RingSize];
+inline std::atomic<std::uint64_t> next_sequence{0};
+inline std::atomic<std::uint32_t> sample_every{EXPECTION_SAMPLE_EVERY};
+
+// Constant initialized, so that no thread_local guard is needed
+inline thread_local std::uint32_t countdown = EXPECTION_SAMPLE_EVERY;
+
+constexpr auto hash_address(std::uint64_t hash, std::uintptr_t address)
+    -> std::uint64_t {
+  // FNV-1a over the bytes of the address
+  for (std::size_t i = 0; i < sizeof(address); ++i) {
+    hash ^= (address >> (8 * i)) & 0xff;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+[[gnu::cold, gnu::noinline]]
+#endif
+inline void capture(const std::source_location &where) {
+  std::uintptr_t return_address = 0;
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+#if defined(__GNUC__) || defined(__clang__)
+  return_address =
+      reinterpret_cast<std::uintptr_t>(__builtin_return_address(0));
+#if defined(EXPECTION_FRAME_POINTERS)
+  // Frame pointer chain: [0] is the caller's frame, [1] the return address.
+  // Stops on anything that doesn't look like a frame further up the stack
+  auto *frame = static_cast<void *const *>(__builtin_frame_address(0));
+  for (std::size_t depth = 0; depth < StackDepth && frame != nullptr;
+       ++depth) {
+    const auto address = reinterpret_cast<std::uintptr_t>(frame[1]);
+    if (address == 0) {
+      break;
+    }
+    hash = hash_address(hash, address);
+
+    auto *next = static_cast<void *const *>(frame[0]);
+    const auto current = reinterpret_cast<std::uintptr_t>(frame);
+    const auto above = reinterpret_cast<std::uintptr_t>(next);
+    if (above <= current || above - current > (1 << 20) ||
+        above % alignof(void *) != 0) {
+      break;
+    }
+    frame = next;
+  }
+#else
+  hash = hash_address(hash, return_address);
+#endif
+#endif
+
+  const auto sequence = next_sequence.fetch_add(1, std::memory_order_relaxed);
+  auto &slot = ring[sequence % RingSize];
+
+  // Skip the sample rather than wait if another writer still owns the slot
+  auto previous = slot.sequence.load(std::memory_order_relaxed);
+  if ((previous & 1) != 0 ||
+      !slot.sequence.compare_exchange_strong(previous, 2 * sequence + 1,
+                                             std::memory_order_relaxed)) {
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot.file.store(where.file_name(), std::memory_order_relaxed);
+  slot.function.store(where.function_name(), std::memory_order_relaxed);
+  slot.line.store(where.line(), std::memory_order_relaxed);
+  slot.return_address.store(return_address, std::memory_order_relaxed);
+  slot.stack_hash.store(hash, std::memory_order_relaxed);
+  slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+}
+
+// Reads a complete slot, returns false if it is empty or being written
+inline auto read(const Slot &slot, FailureSample &sample) -> bool {
+  const auto before = slot.sequence.load(std::memory_order_acquire);
+  if (before == 0 || (before & 1) != 0) {
+    return false;
+  }
+
+  sample.sequence = before / 2 - 1;
+  sample.file = slot.file.load(std::memory_order_relaxed);
+  sample.function = slot.function.load(std::memory_order_relaxed);
+  sample.line = slot.line.load(std::memory_order_relaxed);
+  sample.return_address = slot.return_address.load(std::memory_order_relaxed);
+  sample.stack_hash = slot.stack_hash.load(std::memory_order_relaxed);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+} // namespace detail
+
+// The hook called by every failure helper
+inline void sample_failure(const std::source_location &where) {
+  if (--detail::countdown != 0) [[likely]] {
+    return;
+  }
+  detail::countdown = detail::sample_every.load(std::memory_order_relaxed);
+  detail::capture(where);
+}
+
+// Samples one failure in `every` (at least 1) from now on. The calling
+// thread's countdown restarts immediately, other threads pick the new rate up
+// after their next sample
+inline void set_sample_every(std::uint32_t every) {
+  every = every == 0 ? 1 : every;
+  detail::sample_every.store(every, std::memory_order_relaxed);
+  detail::countdown = every;
+}
+
+// Calls f(const FailureSample &) for every complete sample, oldest first.
+// Lock-free: usable from a signal handler as long as f is
+template <typename F> void for_each_sample(F &&f) {
+  const auto end = detail::next_sequence.load(std::memory_order_acquire);
+  const auto begin = end > RingSize ? end - RingSize : 0;
+  for (auto sequence = begin; sequence < end; ++sequence) {
+    FailureSample sample;
+    if (detail::read(detail::ring[sequence % RingSize], sample) &&
+        sample.sequence == sequence) {
+      f(static_cast<const FailureSample &>(sample));
+    }
+  }
+}
+
+#if __has_include(<unistd.h>)
+namespace detail {
+// Async-signal-safe formatting: no allocation, no locale, only write()
+struct Writer {
+  int fd;
+  char buffer[512];
+  std::size_t size = 0;
+
+  explicit Writer(int fd) : fd(fd) {}
+
+  void flush() {
+    for (std::size_t done = 0; done < size;) {
+      const auto written = ::write(fd, buffer + done, size - done);
+      if (written <= 0) {
+        break;
+      }
+      done += static_cast<std::size_t>(written);
+    }
+    size = 0;
+  }
+
+  void put(char c) {
+    if (size == sizeof(buffer)) {
+      flush();
+    }
+    buffer[size++] = c;
+  }
+
+  void put(const char *text) {
+    for (; text != nullptr && *text != '\0'; ++text) {
+      put(*text);
+    }
+  }
+
+  void put_decimal(std::uint64_t value) {
+    char digits[20];
+    std::size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    while (count != 0) {
+      put(digits[--count]);
+    }
+  }
+
+  void put_hex(std::uint64_t value) {
+    put("0x");
+    for (int shift = 60; shift >= 0; shift -= 4) {
+      put("0123456789abcdef"[(value >> shift) & 0xf]);
+    }
+  }
+};
+} // namespace detail
+
+// Writes every sample to fd, one per line:
+//   #<sequence> <file>:<line> <function> return=0x... stack=0x...
+// Async-signal-safe
+inline void dump(int fd) {
+  detail::Writer out(fd);
+  for_each_sample([&](const FailureSample &sample) {
+    out.put('#');
+    out.put_decimal(sample.sequence);
+    out.put(' ');
+    out.put(sample.line != 0 ? sample.file : "?");
+    out.put(':');
+    out.put_decimal(sample.line);
+    out.put(' ');
+    out.put(sample.line != 0 ? sample.function : "?");
+    out.put(" return=");
+    out.put_hex(sample.return_address);
+    out.put(" stack=");
+    out.put_hex(sample.stack_hash);
+    out.put('\n');
+  });
+  out.flush();
+}
+#endif
+} // namespace Expection::sampling
+
+#endif // ifndef EXPECTION_SAMPLING_HPP
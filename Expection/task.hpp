@@ -0,0 +1,271 @@
+#pragma once
+#ifndef EXPECTION_TASK_HPP
+#define EXPECTION_TASK_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "../Expection.hpp"
+
+namespace Expection {
+
+// === Coroutine Tasks ===
+// Task<R, E, P>: a lazily started coroutine producing ResultType<R, E, P>.
+// co_await on a Task starts it and resumes the awaiter when it finishes
+// (symmetric transfer), evaluating to its ResultType. Under the policies
+// returning errors, failures travel as values through co_return and co_await
+// without throwing. Under the others, exceptions escaping the coroutine are
+// stored by unhandled_exception() and rethrown to the awaiter.
+// Results are stored in the coroutine frame: the frame is the only allocation,
+// and it comes from the frame resource (see set_task_frame_resource), or from
+// a std::pmr::memory_resource * passed after a leading std::allocator_arg
+
+template <typename R, typename E = NoError, Policy P = DefaultPolicy>
+class Task;
+
+namespace detail {
+inline thread_local std::pmr::memory_resource *task_frame_resource = nullptr;
+
+// Frames record where they come from after their end, so that they can be
+// freed on any thread
+struct TaskFrame {
+  static constexpr std::size_t Alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  static auto footer(std::size_t size) -> std::size_t {
+    constexpr auto align = alignof(std::pmr::memory_resource *);
+    return (size + align - 1) / align * align;
+  }
+
+  static auto allocate(std::pmr::memory_resource *resource, std::size_t size)
+      -> void * {
+    if (resource == nullptr) {
+      resource = std::pmr::new_delete_resource();
+    }
+    auto *frame = resource->allocate(
+        footer(size) + sizeof(std::pmr::memory_resource *), Alignment);
+    ::new (static_cast<std::byte *>(frame) + footer(size))
+        std::pmr::memory_resource *(resource);
+    return frame;
+  }
+
+  static void deallocate(void *frame, std::size_t size) {
+    auto *resource = *std::launder(reinterpret_cast<std::pmr::memory_resource **>(
+        static_cast<std::byte *>(frame) + footer(size)));
+    resource->deallocate(
+        frame, footer(size) + sizeof(std::pmr::memory_resource *), Alignment);
+  }
+};
+
+template <typename R, typename E, Policy P> class TaskPromiseBase {
+public:
+  using Result = ResultType<R, E, P>;
+
+  // Frame allocation
+  static auto operator new(std::size_t size) -> void * {
+    return TaskFrame::allocate(task_frame_resource, size);
+  }
+
+  // Freed by the operator delete below too, which reads the resource back
+  // from the frame's footer. GCC 12 takes the pair for a mismatch, since this
+  // overload is a template: its -Wmismatched-new-delete is a false positive
+  // at coroutines taking std::allocator_arg
+  template <typename... Args>
+  static auto operator new(std::size_t size, std::allocator_arg_t,
+                           std::pmr::memory_resource *resource, Args &...)
+      -> void * {
+    return TaskFrame::allocate(resource, size);
+  }
+
+  static void operator delete(void *frame, std::size_t size) {
+    TaskFrame::deallocate(frame, size);
+  }
+
+  auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+  struct FinalAwaiter {
+    auto await_ready() noexcept -> bool { return false; }
+
+    template <typename Promise>
+    auto await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        -> std::coroutine_handle<> {
+      auto &promise = handle.promise();
+      if (promise.continuation_) {
+        return promise.continuation_;
+      }
+      // Awaited by sync_wait(): the frame may be destroyed as soon as the
+      // flag is set, so nothing of it is touched afterwards
+      auto *done = promise.done_;
+      done->store(true, std::memory_order_release);
+      done->notify_one();
+      return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+
+  void unhandled_exception() {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+    result_.template emplace<2>(std::current_exception());
+#else
+    std::terminate();
+#endif
+  }
+
+  // The outcome, moved out once the coroutine is done. Under the policies
+  // returning errors, only foreign exceptions are stored and rethrown. Taking
+  // the outcome of an unfinished coroutine calls EXPECTION_ABORT_HANDLER
+  auto take() -> Result {
+    if (result_.index() != 1) [[unlikely]] {
+      if (result_.index() == 2) {
+        rethrow_cold(std::get<2>(result_));
+      }
+      EXPECTION_ABORT_HANDLER();
+    }
+    if constexpr (!std::is_void_v<Result>) {
+      return std::move(std::get<1>(result_));
+    }
+  }
+
+  std::coroutine_handle<> continuation_;
+  std::atomic<bool> *done_ = nullptr;
+
+protected:
+  using Stored =
+      std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+  std::variant<std::monostate, Stored, std::exception_ptr> result_;
+};
+
+template <typename R, typename E, Policy P>
+class TaskPromise : public TaskPromiseBase<R, E, P> {
+public:
+  using Result = typename TaskPromiseBase<R, E, P>::Result;
+
+  auto get_return_object() -> Task<R, E, P>;
+
+  template <typename T>
+    requires std::constructible_from<Result, T &&>
+  void return_value(T &&result) {
+    this->result_.template emplace<1>(std::forward<T>(result));
+  }
+};
+
+// Under the policies returning R = void, co_return takes no value
+template <typename E, Policy P>
+  requires(!ReturnsExpected<P>)
+class TaskPromise<void, E, P> : public TaskPromiseBase<void, E, P> {
+public:
+  auto get_return_object() -> Task<void, E, P>;
+
+  void return_void() { this->result_.template emplace<1>(); }
+};
+} // namespace detail
+
+// Sets the resource coroutine frames of Tasks created on this thread are
+// allocated from (nullptr for operator new), e.g. a pool. Returns the previous
+// one
+inline auto set_task_frame_resource(std::pmr::memory_resource *resource)
+    -> std::pmr::memory_resource * {
+  return std::exchange(detail::task_frame_resource, resource);
+}
+
+template <typename R, typename E, Policy P> class [[nodiscard]] Task {
+public:
+  using promise_type = detail::TaskPromise<R, E, P>;
+  using Result = ResultType<R, E, P>;
+
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+  Task &operator=(Task &&other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // Starts the task, and resumes the awaiter with its ResultType
+  auto operator co_await() && {
+    struct Awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      auto await_ready() noexcept -> bool { return false; }
+
+      auto await_suspend(std::coroutine_handle<> awaiter) noexcept
+          -> std::coroutine_handle<> {
+        handle.promise().continuation_ = awaiter;
+        return handle;
+      }
+
+      auto await_resume() -> Result { return handle.promise().take(); }
+    };
+    return Awaiter{handle_};
+  }
+
+  // Runs the task to completion on the calling thread, blocking until it
+  // finishes if it is resumed elsewhere
+  friend auto sync_wait(Task task) -> Result {
+    std::atomic<bool> done{false};
+    task.handle_.promise().done_ = &done;
+    task.handle_.resume();
+    done.wait(false, std::memory_order_acquire);
+    return task.handle_.promise().take();
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename R, typename E, Policy P>
+auto detail::TaskPromise<R, E, P>::get_return_object() -> Task<R, E, P> {
+  return Task<R, E, P>(
+      std::coroutine_handle<TaskPromise<R, E, P>>::from_promise(*this));
+}
+
+template <typename E, Policy P>
+  requires(!ReturnsExpected<P>)
+auto detail::TaskPromise<void, E, P>::get_return_object() -> Task<void, E, P> {
+  return Task<void, E, P>(
+      std::coroutine_handle<TaskPromise<void, E, P>>::from_promise(*this));
+}
+
+} // namespace Expection
+
+// Coroutine counterpart of EXPECTION_TRY_ASSIGN: co_returns the error of a
+// failed (non-void) result, e.g. EXPECTION_CO_TRY_ASSIGN(auto x, co_await t)
+#define EXPECTION_CO_TRY_ASSIGN(lhs, ...)                                      \
+  EXPECTION_CO_TRY_ASSIGN_IMPL(                                                \
+      lhs, EXPECTION_TRY_CONCAT(expection_co_try_, __LINE__), __VA_ARGS__)
+
+#define EXPECTION_CO_TRY_ASSIGN_IMPL(lhs, result, ...)                         \
+  auto result = (__VA_ARGS__);                                                 \
+  if constexpr (::Expection::detail::ExpectedResult<decltype(result)>) {       \
+    if (::Expection::detail::try_failed(result)) [[unlikely]] {                \
+      co_return ::Expection::detail::try_error(std::move(result));             \
+    }                                                                          \
+  }                                                                            \
+  lhs = ::Expection::detail::try_value(std::move(result))
+
+#endif // ifndef EXPECTION_TASK_HPP
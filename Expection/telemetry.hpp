@@ -0,0 +1,152 @@
+#pragma once
+#ifndef EXPECTION_TELEMETRY_HPP
+#define EXPECTION_TELEMETRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Default failure hook: per-thread failure counters, indexed by Error type and
+// enum kind. Enabled by defining EXPECTION_TELEMETRY before including
+// Expection.hpp (which then includes this header)
+
+// Number of distinct Error types and kinds per type that are counted. Later
+// types, and kinds past the last one, share the last slot
+#ifndef EXPECTION_TELEMETRY_MAX_TYPES
+#define EXPECTION_TELEMETRY_MAX_TYPES 32
+#endif
+
+#ifndef EXPECTION_TELEMETRY_MAX_KINDS
+#define EXPECTION_TELEMETRY_MAX_KINDS 32
+#endif
+
+namespace Expection::telemetry {
+
+inline constexpr std::size_t MaxTypes = EXPECTION_TELEMETRY_MAX_TYPES;
+inline constexpr std::size_t MaxKinds = EXPECTION_TELEMETRY_MAX_KINDS;
+
+namespace detail {
+// Counters of one thread. Each thread owns a block at a time: the owner is the
+// only writer, so increments are a relaxed load and store, and blocks are
+// cache-line aligned so that no two threads write to the same line.
+// Blocks are never freed: they are reused by later threads, so totals stay
+// correct after threads exit
+struct alignas(64) ThreadCounters {
+  std::atomic<std::uint64_t> counts[MaxTypes][MaxKinds] = {};
+  std::atomic<bool> in_use{true};
+  ThreadCounters *next = nullptr;
+};
+
+inline std::atomic<ThreadCounters *> all_counters{nullptr};
+inline std::atomic<std::size_t> type_count{0};
+
+inline auto acquire_counters() -> ThreadCounters * {
+  for (auto *counters = all_counters.load(std::memory_order_acquire);
+       counters != nullptr; counters = counters->next) {
+    bool expected = false;
+    if (counters->in_use.compare_exchange_strong(expected, true,
+                                                 std::memory_order_acquire)) {
+      return counters;
+    }
+  }
+
+  auto *counters = new ThreadCounters;
+  counters->next = all_counters.load(std::memory_order_relaxed);
+  while (!all_counters.compare_exchange_weak(counters->next, counters,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+  }
+  return counters;
+}
+
+struct ThreadSlot {
+  ThreadCounters *counters = acquire_counters();
+
+  ThreadSlot() = default;
+  ThreadSlot(const ThreadSlot &) = delete;
+  ThreadSlot &operator=(const ThreadSlot &) = delete;
+
+  ~ThreadSlot() { counters->in_use.store(false, std::memory_order_release); }
+};
+
+inline auto local_counters() -> ThreadCounters & {
+  thread_local ThreadSlot slot;
+  return *slot.counters;
+}
+
+template <typename Error> auto type_index() -> std::size_t {
+  static const std::size_t index =
+      type_count.fetch_add(1, std::memory_order_relaxed);
+  return index < MaxTypes ? index : MaxTypes - 1;
+}
+
+template <typename Enum> constexpr auto kind_index(Enum kind) -> std::size_t {
+  const auto index = static_cast<std::size_t>(kind);
+  return index < MaxKinds ? index : MaxKinds - 1;
+}
+
+// The kind of a failure: its first argument if it is an enumerator, or its
+// `kind` member (e.g. for an Error object passed to failure())
+template <typename... Args>
+constexpr auto failure_kind([[maybe_unused]] const Args &...args)
+    -> std::size_t {
+  if constexpr (sizeof...(Args) == 0) {
+    return 0;
+  } else {
+    const auto &first = [](const auto &head, const auto &...) -> const auto & {
+      return head;
+    }(args...);
+    using First = std::remove_cvref_t<decltype(first)>;
+
+    if constexpr (std::is_enum_v<First>) {
+      return kind_index(first);
+    } else if constexpr (requires { requires std::is_enum_v<
+                                        decltype(first.kind)>; }) {
+      return kind_index(first.kind);
+    } else {
+      return 0;
+    }
+  }
+}
+} // namespace detail
+
+// The hook invoked by make_failure/failure
+template <typename Error, typename... Args>
+void count_failure(const Args &...args) {
+  auto &counter = detail::local_counters()
+                      .counts[detail::type_index<Error>()]
+                             [detail::failure_kind(args...)];
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+// Failures of Error with the given kind, summed over all threads
+template <typename Error, typename Enum>
+  requires std::is_enum_v<Enum>
+auto failure_count(Enum kind) -> std::uint64_t {
+  std::uint64_t total = 0;
+  const auto type = detail::type_index<Error>();
+  const auto index = detail::kind_index(kind);
+  for (auto *counters = detail::all_counters.load(std::memory_order_acquire);
+       counters != nullptr; counters = counters->next) {
+    total += counters->counts[type][index].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+// Failures of Error of any kind, summed over all threads
+template <typename Error> auto failure_count() -> std::uint64_t {
+  std::uint64_t total = 0;
+  const auto type = detail::type_index<Error>();
+  for (auto *counters = detail::all_counters.load(std::memory_order_acquire);
+       counters != nullptr; counters = counters->next) {
+    for (const auto &count : counters->counts[type]) {
+      total += count.load(std::memory_order_relaxed);
+    }
+  }
+  return total;
+}
+} // namespace Expection::telemetry
+
+#endif // ifndef EXPECTION_TELEMETRY_HPP
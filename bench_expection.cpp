@@ -0,0 +1,322 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Expection.hpp"
+#include "Expection/parallel.hpp"
+
+// Same Error type and failure methods as testexpection.cpp, benchmarked for
+// every combination of failure method, policy and failure rate. Kept
+// out-of-line so that every instantiation is a real call (as it would be
+// across translation units), and shows up as its own symbol for size reports
+#define DIVIDE_BY_SPECIFIERS [[gnu::noinline]]
+#include "divide_by_fixture.hpp"
+
+using namespace Expection;
+
+// Counts branch misses of the calling thread through perf_event_open. Reports
+// nothing where hardware counters aren't available
+class BranchMisses {
+public:
+  BranchMisses() {
+#if defined(__linux__)
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  BranchMisses(const BranchMisses &) = delete;
+  BranchMisses &operator=(const BranchMisses &) = delete;
+
+  ~BranchMisses() {
+#if defined(__linux__)
+    if (fd_ != -1) {
+      close(fd_);
+    }
+#endif
+  }
+
+  bool available() const { return fd_ != -1; }
+
+  void start() {
+#if defined(__linux__)
+    if (available()) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  std::uint64_t stop() {
+    std::uint64_t count = 0;
+#if defined(__linux__)
+    if (available()) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+      }
+    }
+#endif
+    return count;
+  }
+
+private:
+  int fd_ = -1;
+};
+
+// Calls per benchmark iteration, and the failure rates to measure (per 10000
+// calls: 0%, 0.1%, 1%, 10% and 50%)
+inline constexpr std::size_t CallsPerIteration = 10000;
+inline constexpr int FailureRates[] = {0, 10, 100, 1000, 5000};
+
+struct Inputs {
+  std::vector<int> numerators;
+  std::vector<int> denominators;
+};
+
+// Exactly `failures` zero denominators, shuffled with a fixed seed so that
+// every benchmark sees the same sequence
+inline auto make_inputs(std::size_t failures) {
+  Inputs inputs;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> values(1, 1000);
+
+  for (std::size_t i = 0; i < CallsPerIteration; ++i) {
+    inputs.numerators.push_back(values(rng));
+    inputs.denominators.push_back(i < failures ? 0 : values(rng));
+  }
+  std::shuffle(inputs.denominators.begin(), inputs.denominators.end(), rng);
+  return inputs;
+}
+
+template <FailureMethod F, Policy P>
+inline void call_all(const Inputs &inputs, double &sum,
+                     std::size_t &failures) {
+  for (std::size_t i = 0; i < CallsPerIteration; ++i) {
+    if constexpr (P == Policy::Exceptions) {
+      try {
+        sum += divide_by<F, P>(inputs.numerators[i], inputs.denominators[i]);
+      } catch (const std::runtime_error &) {
+        ++failures;
+      }
+    } else {
+      auto result =
+          divide_by<F, P>(inputs.numerators[i], inputs.denominators[i]);
+      if (result.has_value()) {
+        sum += *result;
+      } else {
+        ++failures;
+      }
+    }
+  }
+}
+
+template <FailureMethod F, Policy P>
+void BM_divide_by(benchmark::State &state) {
+  const auto inputs = make_inputs(static_cast<std::size_t>(state.range(0)));
+  BranchMisses branch_misses;
+  std::uint64_t misses = 0;
+
+  for (auto _ : state) {
+    double sum = 0;
+    std::size_t failures = 0;
+
+    branch_misses.start();
+    call_all<F, P>(inputs, sum, failures);
+    misses += branch_misses.stop();
+
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(failures);
+  }
+
+  const auto calls = static_cast<double>(CallsPerIteration);
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(CallsPerIteration));
+  state.counters["time/call"] = benchmark::Counter(
+      calls, benchmark::Counter::kIsIterationInvariantRate |
+                 benchmark::Counter::kInvert);
+  if (branch_misses.available()) {
+    state.counters["branch-misses/call"] = benchmark::Counter(
+        static_cast<double>(misses) /
+        (calls * static_cast<double>(state.iterations())));
+  }
+}
+
+void failure_rates(benchmark::internal::Benchmark *bench) {
+  bench->ArgName("failures_per_10k");
+  for (auto rate : FailureRates) {
+    bench->Arg(rate);
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::InPlace, Policy::Exceptions)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::Functor, Policy::Exceptions)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::Callable, Policy::Exceptions)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::Conversion, Policy::Exceptions)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::InPlace, Policy::Expected)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::Functor, Policy::Expected)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::Callable, Policy::Expected)
+    ->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_divide_by, FailureMethod::Conversion, Policy::Expected)
+    ->Apply(failure_rates);
+
+// A call graph DeepLayers deep, failing at its leaf: under Policy::Exceptions
+// throughout, or under Policy::Boundary with throw_if_error() at its edge,
+// both caught by the caller
+inline constexpr int DeepLayers = 8;
+
+template <Policy P, int Layer>
+[[gnu::noinline]] auto deep_call(int numerator, int denominator)
+    -> ResultType<double, DivideByError, P> {
+  if constexpr (Layer == 0) {
+    return divide_by<FailureMethod::InPlace, P>(numerator, denominator);
+  } else {
+    EXPECTION_TRY_ASSIGN(auto value,
+                         deep_call<P, Layer - 1>(numerator, denominator));
+    return success<double, DivideByError, P>(value + 1);
+  }
+}
+
+template <Policy P> void BM_deep_call(benchmark::State &state) {
+  const auto inputs = make_inputs(static_cast<std::size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    double sum = 0;
+    std::size_t failures = 0;
+    for (std::size_t i = 0; i < CallsPerIteration; ++i) {
+      try {
+        if constexpr (P == Policy::Boundary) {
+          sum += throw_if_error(deep_call<P, DeepLayers>(
+              inputs.numerators[i], inputs.denominators[i]));
+        } else {
+          sum += deep_call<P, DeepLayers>(inputs.numerators[i],
+                                          inputs.denominators[i]);
+        }
+      } catch (const std::runtime_error &) {
+        ++failures;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(failures);
+  }
+
+  state.counters["time/call"] = benchmark::Counter(
+      static_cast<double>(CallsPerIteration),
+      benchmark::Counter::kIsIterationInvariantRate |
+          benchmark::Counter::kInvert);
+}
+
+BENCHMARK_TEMPLATE(BM_deep_call, Policy::Exceptions)->Apply(failure_rates);
+BENCHMARK_TEMPLATE(BM_deep_call, Policy::Boundary)->Apply(failure_rates);
+
+// Scaling of parallel::transform_reduce with the number of threads, over a
+// range without failures, and with a single failure in the middle (after which
+// the remaining work is cancelled)
+inline constexpr std::size_t ParallelElements = 1 << 22;
+
+template <Policy P> void BM_parallel_transform_reduce(benchmark::State &state) {
+  const auto threads = static_cast<std::size_t>(state.range(0));
+  std::vector<int> denominators(ParallelElements);
+  for (std::size_t i = 0; i < denominators.size(); ++i) {
+    denominators[i] = static_cast<int>(i % 1000) + 1;
+  }
+  if (state.range(1) != 0) {
+    denominators[denominators.size() / 2] = 0;
+  }
+
+  auto divide = [](int denominator) {
+    return divide_by<FailureMethod::InPlace, P>(1000, denominator);
+  };
+
+  for (auto _ : state) {
+    if constexpr (P == Policy::Exceptions) {
+      try {
+        benchmark::DoNotOptimize(
+            parallel::transform_reduce<DivideByError, P>(
+                denominators, 0.0, std::plus<>{}, divide, threads));
+      } catch (const std::runtime_error &) {
+      }
+    } else {
+      benchmark::DoNotOptimize(parallel::transform_reduce<DivideByError, P>(
+          denominators, 0.0, std::plus<>{}, divide, threads));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(ParallelElements));
+}
+
+void thread_counts(benchmark::internal::Benchmark *bench) {
+  bench->ArgNames({"threads", "failing"});
+  bench->ArgsProduct({{1, 2, 4, 8, 16, 32, 64}, {0, 1}});
+  bench->UseRealTime();
+}
+
+BENCHMARK_TEMPLATE(BM_parallel_transform_reduce, Policy::Exceptions)
+    ->Apply(thread_counts);
+BENCHMARK_TEMPLATE(BM_parallel_transform_reduce, Policy::Expected)
+    ->Apply(thread_counts);
+
+// Cost of a throw and catch under Policy::Exceptions, with the exception
+// built from DivideByError::exception() (std::runtime_error) or a
+// light_exception copying the Error
+struct LightDivideByError {
+  DivideByError::Kind kind;
+
+  static constexpr char const *err_to_str(DivideByError::Kind kind) {
+    return DivideByError::err_to_str(kind);
+  }
+
+  static auto exception(DivideByError::Kind k) {
+    return light_exception(LightDivideByError{k});
+  }
+};
+
+template <typename Error>
+[[gnu::noinline]] auto fail_with(int denominator)
+    -> ResultType<int, Error, Policy::Exceptions> {
+  if (denominator == 0) {
+    return make_failure<int, Error, Policy::Exceptions>(
+        DivideByError::Kind::DivideByZero);
+  }
+  return denominator;
+}
+
+template <typename Error> void BM_throw(benchmark::State &state) {
+  int denominator = 0;
+  benchmark::DoNotOptimize(denominator);
+  for (auto _ : state) {
+    try {
+      benchmark::DoNotOptimize(fail_with<Error>(denominator));
+    } catch (const std::exception &exception) {
+      benchmark::DoNotOptimize(&exception);
+    }
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_throw, DivideByError);
+BENCHMARK_TEMPLATE(BM_throw, LightDivideByError);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,62 @@
+# Compiles SOURCE to assembly and checks that the functions FIRST and SECOND
+# are made of the same instructions, once local labels are normalized and
+# instruction scheduling differences are ignored.
+#
+# Usage: cmake -DCXX=<compiler> -DSOURCE=<file> -DINCLUDE=<dir> -DOUTPUT=<file>
+#              -DFIRST=<symbol> -DSECOND=<symbol> -P CompareCodegen.cmake
+
+execute_process(
+  COMMAND ${CXX} -std=c++23 -O3 -DNDEBUG -I${INCLUDE} -S -o ${OUTPUT} ${SOURCE}
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Failed to compile ${SOURCE} to assembly")
+endif()
+
+file(READ ${OUTPUT} asm)
+
+function(extract_body symbol out_var)
+  # Darwin prefixes C symbols with an underscore
+  set(label "")
+  foreach(candidate "${symbol}:" "_${symbol}:")
+    string(FIND "${asm}" "\n${candidate}\n" start)
+    if(NOT start EQUAL -1)
+      set(label "${candidate}")
+      break()
+    endif()
+  endforeach()
+  if(label STREQUAL "")
+    message(FATAL_ERROR "Symbol ${symbol} not found in ${OUTPUT}")
+  endif()
+
+  string(LENGTH "\n${label}\n" label_length)
+  math(EXPR start "${start} + ${label_length}")
+  string(SUBSTRING "${asm}" ${start} -1 body)
+
+  # The body ends with the function's call frame information
+  string(FIND "${body}" ".cfi_endproc" end)
+  if(end EQUAL -1)
+    message(FATAL_ERROR "End of ${symbol} not found in ${OUTPUT}")
+  endif()
+  string(SUBSTRING "${body}" 0 ${end} body)
+  string(REGEX REPLACE "\\.?L[A-Za-z_]*[0-9]+" "<label>" body "${body}")
+  string(REGEX REPLACE "${symbol}" "<symbol>" body "${body}")
+
+  # Compare as a sorted list of instructions
+  string(REPLACE ";" "<semicolon>" body "${body}")
+  string(REPLACE "\n" ";" lines "${body}")
+  list(SORT lines)
+  set(${out_var} "${lines}" PARENT_SCOPE)
+endfunction()
+
+extract_body(${FIRST} first_body)
+extract_body(${SECOND} second_body)
+
+if(NOT first_body STREQUAL second_body)
+  string(REPLACE ";" "\n" first_body "${first_body}")
+  string(REPLACE ";" "\n" second_body "${second_body}")
+  message(FATAL_ERROR "Codegen of ${FIRST} differs from ${SECOND}:\n"
+                      "--- ${FIRST} (sorted)\n${first_body}\n"
+                      "--- ${SECOND} (sorted)\n${second_body}")
+endif()
+
+message(STATUS "Codegen of ${FIRST} matches ${SECOND}")
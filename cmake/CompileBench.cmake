@@ -0,0 +1,143 @@
+# Compile-time benchmark: measures the cost of including Expection/core.hpp and
+# Expection.hpp over <expected> alone, and of FUNCTIONS functions failing
+# through make_failure/failure (rotating over the failure methods, each
+# instantiated under Policy::Exceptions and Policy::Expected) over the same
+# functions written against std::expected and throw directly, as templates on
+# whether they throw, also instantiated twice. Every source is
+# compiled with -fsyntax-only, REPEAT times, and the fastest run is reported.
+# The Expection sources must compile within -ftemplate-depth=TEMPLATE_DEPTH.
+#
+# Usage: cmake -DCXX=<compiler> -DINCLUDE=<dir> -DOUTPUT=<dir>
+#              [-DFUNCTIONS=200] [-DREPEAT=5] [-DTEMPLATE_DEPTH=<budget>]
+#              -P CompileBench.cmake
+
+if(NOT DEFINED FUNCTIONS)
+  set(FUNCTIONS 200)
+endif()
+if(NOT DEFINED REPEAT)
+  set(REPEAT 5)
+endif()
+if(NOT DEFINED TEMPLATE_DEPTH)
+  set(TEMPLATE_DEPTH 32)
+endif()
+
+file(MAKE_DIRECTORY ${OUTPUT})
+
+file(WRITE ${OUTPUT}/include_expected.cpp "#include <expected>\n")
+file(WRITE ${OUTPUT}/include_core.cpp "#include \"Expection/core.hpp\"\n")
+file(WRITE ${OUTPUT}/include_full.cpp "#include \"Expection.hpp\"\n")
+
+set(baseline "#include <expected>\n#include <stdexcept>\n#include <type_traits>\n")
+set(expection "#include <stdexcept>\n\n#include \"Expection/core.hpp\"\n")
+math(EXPR last "${FUNCTIONS} - 1")
+foreach(i RANGE ${last})
+  set(error "Error${i}")
+  set(kind "${error}::Kind::Failed")
+  set(declaration "
+struct ${error} {
+  enum class Kind { Failed };
+  Kind kind;
+  static constexpr const char *err_to_str(Kind) { return \"${error}\"; }
+  static auto exception(Kind) { return std::runtime_error(\"${error}\"); }
+  auto exception() const { return std::runtime_error(\"${error}\"); }
+};
+")
+  string(APPEND baseline "${declaration}
+template <bool Throwing>
+auto function${i}(int x)
+    -> std::conditional_t<Throwing, int, std::expected<int, ${error}>> {
+  if (x == ${i}) {
+    if constexpr (Throwing) {
+      throw ${error}::exception(${kind});
+    } else {
+      return std::unexpected(${error}{${kind}});
+    }
+  }
+  return x;
+}
+
+template auto function${i}<true>(int) -> int;
+template auto function${i}<false>(int) -> std::expected<int, ${error}>;
+")
+
+  math(EXPR method "${i} % 4")
+  if(method EQUAL 0)
+    set(failure "Expection::make_failure<int, ${error}, P>(${kind})")
+  elseif(method EQUAL 1)
+    set(failure "Expection::make_failure<int, ${error}, ${error}Functor, P>(${kind})")
+  elseif(method EQUAL 2)
+    set(failure "Expection::make_failure<int, ${error}, P>(
+        [](${error}::Kind k) { return std::unexpected<${error}>(k); },
+        [](${error}::Kind k) { return ${error}::exception(k); }, ${kind})")
+  else()
+    set(failure "Expection::failure<int, P>(${error}{${kind}})")
+  endif()
+  string(APPEND expection "${declaration}
+struct ${error}Functor {
+  static auto unexpected(${error}::Kind k) { return std::unexpected<${error}>(k); }
+  static auto exception(${error}::Kind k) { return ${error}::exception(k); }
+};
+
+template <Expection::Policy P>
+auto function${i}(int x) -> Expection::ResultType<int, ${error}, P> {
+  if (x == ${i}) {
+    return ${failure};
+  }
+  return Expection::success<int, ${error}, P>(x);
+}
+
+template auto function${i}<Expection::Policy::Exceptions>(int)
+    -> Expection::ResultType<int, ${error}, Expection::Policy::Exceptions>;
+template auto function${i}<Expection::Policy::Expected>(int)
+    -> Expection::ResultType<int, ${error}, Expection::Policy::Expected>;
+")
+endforeach()
+file(WRITE ${OUTPUT}/functions_expected.cpp "${baseline}")
+file(WRITE ${OUTPUT}/functions_expection.cpp "${expection}")
+
+# Microseconds since the epoch: %f is the 6-digit fraction of %s
+function(now_us out_var)
+  string(TIMESTAMP value "%s%f" UTC)
+  set(${out_var} ${value} PARENT_SCOPE)
+endfunction()
+
+# Fastest of REPEAT compilations of source, in milliseconds
+function(compile_time source out_var)
+  set(best "")
+  foreach(run RANGE 1 ${REPEAT})
+    now_us(start)
+    execute_process(
+      COMMAND ${CXX} -std=c++23 -fsyntax-only -ftemplate-depth=${TEMPLATE_DEPTH}
+              -I${INCLUDE} ${OUTPUT}/${source}
+      RESULT_VARIABLE result
+      ERROR_VARIABLE errors)
+    now_us(end)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "Failed to compile ${source} within "
+                          "-ftemplate-depth=${TEMPLATE_DEPTH}:\n${errors}")
+    endif()
+    math(EXPR elapsed "(${end} - ${start}) / 1000")
+    if(best STREQUAL "" OR elapsed LESS best)
+      set(best ${elapsed})
+    endif()
+  endforeach()
+  set(${out_var} ${best} PARENT_SCOPE)
+endfunction()
+
+compile_time(include_expected.cpp include_expected)
+compile_time(include_core.cpp include_core)
+compile_time(include_full.cpp include_full)
+compile_time(functions_expected.cpp functions_expected)
+compile_time(functions_expection.cpp functions_expection)
+
+math(EXPR core_cost "${include_core} - ${include_expected}")
+math(EXPR full_cost "${include_full} - ${include_expected}")
+math(EXPR functions_cost "${functions_expection} - ${functions_expected}")
+math(EXPR per_function "${functions_cost} * 1000 / ${FUNCTIONS}")
+
+message("#include <expected>                ${include_expected} ms")
+message("#include \"Expection/core.hpp\"      ${include_core} ms (+${core_cost} ms)")
+message("#include \"Expection.hpp\"           ${include_full} ms (+${full_cost} ms)")
+message("${FUNCTIONS} functions, std::expected  ${functions_expected} ms")
+message("${FUNCTIONS} functions, Expection      ${functions_expection} ms "
+        "(+${functions_cost} ms, ${per_function} us per function)")
@@ -0,0 +1,94 @@
+# Turns failure-rate profiles written under EXPECTION_PROFILE into a header of
+# policy selections, to be named by EXPECTION_SELECTED_POLICIES: functions
+# failing more than BREAK_EVEN times per million calls get Policy::Expected,
+# the others Policy::Exceptions. The default is where the two policies cross
+# in bench_expection, between its 0.1% and 1% failure rates. Functions with
+# fewer than MINIMUM_CALLS calls and Expection's own are left out, keeping
+# DefaultPolicy. So are unlocated outcomes (of helpers called with more than
+# three deduced arguments), with a warning if there are failures among them.
+# Functions in anonymous namespaces are kept: the selection applies to every
+# function of that name in an anonymous namespace. The counts of every profile
+# in PROFILES (separated by commas) are summed, and OUTPUT is only rewritten if
+# it changes.
+#
+# Usage: cmake -DPROFILES=<files> -DOUTPUT=<header> [-DBREAK_EVEN=1000]
+#              [-DMINIMUM_CALLS=100] -P PolicyProfile.cmake
+
+if(NOT DEFINED BREAK_EVEN)
+  set(BREAK_EVEN 1000)
+endif()
+if(NOT DEFINED MINIMUM_CALLS)
+  set(MINIMUM_CALLS 100)
+endif()
+
+string(REPLACE "," ";" profiles "${PROFILES}")
+
+# Qualified names, with GCC's and Clang's spellings of anonymous namespaces
+set(name "[A-Za-z_][A-Za-z0-9_]*")
+set(scope "([(]anonymous namespace[)]|[{]anonymous[}]|${name})::")
+
+set(functions)
+set(unlocated 0)
+foreach(profile IN LISTS profiles)
+  if(NOT EXISTS ${profile})
+    message(FATAL_ERROR "Profile ${profile} not found")
+  endif()
+  file(STRINGS ${profile} lines)
+  foreach(line IN LISTS lines)
+    # <successes> <failures> <function>, or - for unlocated outcomes
+    if(line MATCHES "^[0-9]+ ([0-9]+) -$")
+      math(EXPR unlocated "${unlocated} + ${CMAKE_MATCH_1}")
+      continue()
+    endif()
+    if(NOT line MATCHES "^([0-9]+) ([0-9]+) ((${scope})*${name})$")
+      continue()
+    endif()
+    set(successes ${CMAKE_MATCH_1})
+    set(failures ${CMAKE_MATCH_2})
+    set(function "${CMAKE_MATCH_3}")
+    if(function MATCHES "^Expection::")
+      continue()
+    endif()
+    string(MAKE_C_IDENTIFIER "${function}" id)
+    if(NOT DEFINED calls_${id})
+      list(APPEND functions "${function}")
+      set(calls_${id} 0)
+      set(failures_${id} 0)
+    endif()
+    math(EXPR calls_${id} "${calls_${id}} + ${successes} + ${failures}")
+    math(EXPR failures_${id} "${failures_${id}} + ${failures}")
+  endforeach()
+endforeach()
+
+if(unlocated GREATER 0)
+  message(WARNING "${unlocated} failures have no location and are left out: "
+                  "make them with make_failure_at() to attribute them")
+endif()
+
+list(SORT functions)
+set(header "// Policy selections generated by cmake/PolicyProfile.cmake from
+// ${PROFILES}
+// (break-even at ${BREAK_EVEN} failures per million calls). Included by
+// Expection/core.hpp through EXPECTION_SELECTED_POLICIES: do not edit
+")
+foreach(function IN LISTS functions)
+  string(MAKE_C_IDENTIFIER "${function}" id)
+  set(calls ${calls_${id}})
+  set(failures ${failures_${id}})
+  if(calls LESS MINIMUM_CALLS)
+    continue()
+  endif()
+  math(EXPR rate "${failures} * 1000000 / ${calls}")
+  if(rate GREATER BREAK_EVEN)
+    set(policy Expected)
+  else()
+    set(policy Exceptions)
+  endif()
+  set(selection "EXPECTION_SELECT(${function}, ${policy})")
+  string(APPEND header "${selection} // ${failures} failures in ${calls} calls\n")
+  message("${selection}: ${failures} failures in ${calls} calls")
+endforeach()
+
+file(WRITE ${OUTPUT}.tmp "${header}")
+configure_file(${OUTPUT}.tmp ${OUTPUT} COPYONLY)
+file(REMOVE ${OUTPUT}.tmp)
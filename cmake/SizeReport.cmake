@@ -0,0 +1,93 @@
+# Prints the size of the .text, .eh_frame and .gcc_except_table sections of
+# every binary in BINARIES (separated by commas), and its number of template
+# instantiations. Instantiations are counted from the -ftime-trace files found
+# under TRACE_ROOT/<binary name>.dir (Clang), otherwise the weak symbols of the
+# binary (inline and template functions that were emitted) are counted.
+#
+# Usage: cmake -DOBJDUMP=<objdump> -DNM=<nm> -DBINARIES=<files>
+#              -DTRACE_ROOT=<dir> -P SizeReport.cmake
+
+string(REPLACE "," ";" binaries "${BINARIES}")
+
+function(pad text width out_var)
+  string(LENGTH "${text}" length)
+  while(length LESS width)
+    string(APPEND text " ")
+    math(EXPR length "${length} + 1")
+  endwhile()
+  set(${out_var} "${text}" PARENT_SCOPE)
+endfunction()
+
+function(section_sizes binary text_var eh_frame_var except_table_var)
+  execute_process(
+    COMMAND ${OBJDUMP} -h ${binary}
+    OUTPUT_VARIABLE sections
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Failed to read the sections of ${binary}")
+  endif()
+
+  set(text 0)
+  set(eh_frame 0)
+  set(except_table 0)
+  string(REPLACE "\n" ";" sections "${sections}")
+  foreach(line IN LISTS sections)
+    # <index> <name> <size> <vma> ...
+    if(line MATCHES "^ *[0-9]+ ([^ ]+) +([0-9a-fA-F]+) ")
+      set(name "${CMAKE_MATCH_1}")
+      math(EXPR size "0x${CMAKE_MATCH_2}")
+      if(name STREQUAL ".text" OR name MATCHES "^\\.text\\.")
+        math(EXPR text "${text} + ${size}")
+      elseif(name STREQUAL ".eh_frame")
+        math(EXPR eh_frame "${eh_frame} + ${size}")
+      elseif(name MATCHES "^\\.gcc_except_table")
+        math(EXPR except_table "${except_table} + ${size}")
+      endif()
+    endif()
+  endforeach()
+  set(${text_var} ${text} PARENT_SCOPE)
+  set(${eh_frame_var} ${eh_frame} PARENT_SCOPE)
+  set(${except_table_var} ${except_table} PARENT_SCOPE)
+endfunction()
+
+function(instantiations binary count_var source_var)
+  get_filename_component(name ${binary} NAME_WE)
+  file(GLOB_RECURSE traces "${TRACE_ROOT}/${name}.dir/*.json")
+  set(count 0)
+  if(traces)
+    foreach(trace IN LISTS traces)
+      file(READ ${trace} events)
+      string(REGEX MATCHALL "\"name\": *\"Instantiate(Function|Class)\""
+             matches "${events}")
+      list(LENGTH matches found)
+      math(EXPR count "${count} + ${found}")
+    endforeach()
+    set(${source_var} "-ftime-trace" PARENT_SCOPE)
+  else()
+    execute_process(
+      COMMAND ${NM} ${binary}
+      OUTPUT_VARIABLE symbols
+      RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "Failed to read the symbols of ${binary}")
+    endif()
+    string(REGEX MATCHALL "\n[0-9a-fA-F]* *[Ww] " matches "\n${symbols}")
+    list(LENGTH matches count)
+    set(${source_var} "weak symbols" PARENT_SCOPE)
+  endif()
+  set(${count_var} ${count} PARENT_SCOPE)
+endfunction()
+
+pad("binary" 32 header)
+message("${header}   .text   .eh_frame   .gcc_except_table   instantiations")
+foreach(binary IN LISTS binaries)
+  section_sizes(${binary} text eh_frame except_table)
+  instantiations(${binary} count source)
+
+  get_filename_component(name ${binary} NAME)
+  pad("${name}" 32 name)
+  pad("${text}" 8 text)
+  pad("${eh_frame}" 12 eh_frame)
+  pad("${except_table}" 20 except_table)
+  message("${name}   ${text}${eh_frame}${except_table}${count} (${source})")
+endforeach()
@@ -0,0 +1,32 @@
+# Prints the size of every symbol of BINARY whose demangled name matches
+# FILTER (a regular expression).
+#
+# Usage: cmake -DNM=<nm> -DBINARY=<file> -DFILTER=<regex> -P SymbolSizes.cmake
+
+execute_process(
+  COMMAND ${NM} -C -S --size-sort ${BINARY}
+  OUTPUT_VARIABLE symbols
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Failed to read the symbols of ${BINARY}")
+endif()
+
+string(REPLACE ";" "<semicolon>" symbols "${symbols}")
+string(REPLACE "\n" ";" symbols "${symbols}")
+
+set(total 0)
+foreach(line IN LISTS symbols)
+  # <address> <size> <type> <name>
+  if(line MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) [A-Za-z] (.*)$")
+    set(size "0x${CMAKE_MATCH_1}")
+    set(name "${CMAKE_MATCH_2}")
+    if(name MATCHES "${FILTER}")
+      math(EXPR size "${size}")
+      math(EXPR total "${total} + ${size}")
+      string(REPLACE "<semicolon>" ";" name "${name}")
+      message("${size}\t${name}")
+    endif()
+  endif()
+endforeach()
+
+message("${total}\ttotal")
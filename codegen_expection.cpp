@@ -0,0 +1,59 @@
+// Codegen checks for Policy::Unchecked and unwrap_unchecked: the loops over
+// divide_by<Unchecked> and over unwrap_unchecked(divide_by<Expected>) must
+// compile to the exact same instructions as the hand-written loop.
+// Compiled to assembly and compared by cmake/CompareCodegen.cmake
+
+#include <cstddef>
+
+#include "Expection.hpp"
+
+struct DivideByError {
+  enum class Kind { DivideByZero };
+
+  Kind kind;
+
+  static auto exception(Kind) { return std::runtime_error("Division by Zero"); }
+};
+
+template <Expection::Policy P = Expection::DefaultPolicy>
+auto divide_by(int numerator, int denominator)
+    -> Expection::ResultType<double, DivideByError, P> {
+  using Expection::make_failure, Expection::success;
+  using Result = double;
+  using Error = DivideByError;
+
+  if (denominator == 0) {
+    return make_failure<Result, Error, P>(DivideByError::Kind::DivideByZero);
+  }
+
+  return success<Result, Error, P>(static_cast<Result>(numerator) /
+                                   denominator);
+}
+
+extern "C" void divide_unchecked(const int *numerators,
+                                 const int *denominators, double *out,
+                                 std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = divide_by<Expection::Policy::Unchecked>(numerators[i],
+                                                     denominators[i]);
+  }
+}
+
+extern "C" void divide_handwritten(const int *numerators,
+                                   const int *denominators, double *out,
+                                   std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = static_cast<double>(numerators[i]) / denominators[i];
+  }
+}
+
+// unwrap_unchecked must remove the error path of Policy::Expected entirely
+extern "C" void divide_unwrap_unchecked(const int *numerators,
+                                        const int *denominators, double *out,
+                                        std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = Expection::unwrap_unchecked<Expection::Policy::Expected>(
+        divide_by<Expection::Policy::Expected>(numerators[i],
+                                               denominators[i]));
+  }
+}
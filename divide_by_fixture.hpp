@@ -0,0 +1,94 @@
+// Example Error type and divide_by, shared by testexpection.cpp,
+// bench_expection.cpp and fuzz_expection.cpp
+// NOTE: This is checking *all* the possible conversion methods from Expection,
+// Realistically, you only need to implement one of them
+// Suggested implementation: `static auto exception(args...)` inside Error class
+#pragma once
+#ifndef DIVIDE_BY_FIXTURE_HPP
+#define DIVIDE_BY_FIXTURE_HPP
+
+#include <expected>
+#include <stdexcept>
+#include <utility>
+
+#include "Expection.hpp"
+
+// Specifiers of divide_by. bench_expection.cpp keeps every instantiation
+// out-of-line instead, so that it is a real call with a symbol of its own
+#ifndef DIVIDE_BY_SPECIFIERS
+#define DIVIDE_BY_SPECIFIERS constexpr
+#endif
+
+struct DivideByError {
+  enum class Kind { DivideByZero };
+
+  Kind kind;
+
+  static constexpr char const *err_to_str(Kind kind) {
+    switch (kind) {
+    case Kind::DivideByZero:
+      return "Division by Zero";
+
+    default:
+      std::unreachable();
+    };
+  }
+
+  auto str() { return err_to_str(kind); }
+
+  // In-place exception construction
+  static auto exception(Kind k) { return std::runtime_error(err_to_str(k)); }
+
+  // Convert to exception
+  auto exception() { return std::runtime_error(err_to_str(kind)); }
+};
+
+struct DivideByErrorFunctor {
+  static auto unexpected(DivideByError::Kind k) {
+    return std::unexpected<DivideByError>(k);
+  }
+
+  static auto exception(DivideByError::Kind k) {
+    return std::runtime_error(DivideByError::err_to_str(k));
+  }
+};
+
+// NOTE: we are only using "FailureMethod" as a template parameter for our unit
+// tests, For actual use of the library, you'd just choose one and only have
+// Policy as the template parameter
+enum class FailureMethod { InPlace, Functor, Callable, Conversion };
+
+template <FailureMethod F, Expection::Policy P = Expection::DefaultPolicy>
+DIVIDE_BY_SPECIFIERS auto divide_by(int numerator, int denominator)
+    -> Expection::ResultType<double, DivideByError, P> {
+  using Result = double;
+  using Error = DivideByError;
+
+  if (denominator == 0) {
+    if constexpr (F == FailureMethod::InPlace) {
+      return Expection::make_failure<Result, Error, P>(
+          DivideByError::Kind::DivideByZero);
+    } else if constexpr (F == FailureMethod::Functor) {
+      return Expection::make_failure<Result, Error, DivideByErrorFunctor, P>(
+          DivideByError::Kind::DivideByZero);
+    } else if constexpr (F == FailureMethod::Callable) {
+      auto make_unexpected = [](DivideByError::Kind k) {
+        return std::unexpected<DivideByError>(k);
+      };
+
+      auto make_exception = [](DivideByError::Kind k) {
+        return std::runtime_error(DivideByError::err_to_str(k));
+      };
+      return Expection::make_failure<Result, Error, P>(
+          make_unexpected, make_exception, DivideByError::Kind::DivideByZero);
+    } else if constexpr (F == FailureMethod::Conversion) {
+      auto err = DivideByError{DivideByError::Kind::DivideByZero};
+      return Expection::failure<Result, P>(err);
+    }
+  }
+
+  return Expection::success<Result, Error, P>(static_cast<Result>(numerator) /
+                                              denominator);
+}
+
+#endif // ifndef DIVIDE_BY_FIXTURE_HPP
@@ -0,0 +1,18 @@
+#include "divide.hpp"
+
+template <Expection::Policy P>
+auto divide_by(int numerator, int denominator)
+    -> Expection::ResultType<double, DivideByError, P> {
+  using Expection::make_failure, Expection::success;
+  using Result = double;
+  using Error = DivideByError;
+
+  if (denominator == 0) {
+    return make_failure<Result, Error, P>(DivideByError::Kind::DivideByZero);
+  }
+
+  auto val = static_cast<double>(numerator) / denominator;
+  return success<Result, Error, P>(val);
+}
+
+EXPECTION_INSTANTIATE_POLICIES(divide_by);
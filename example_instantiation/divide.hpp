@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Expection.hpp"
+
+struct DivideByError {
+  enum class Kind { DivideByZero };
+
+  Kind kind;
+
+  static constexpr char const *err_to_str(Kind kind) {
+    switch (kind) {
+    case Kind::DivideByZero:
+      return "Division by Zero";
+
+    default:
+      std::unreachable();
+    };
+  }
+
+  auto str() { return err_to_str(kind); }
+
+  // In-place exception construction
+  static auto exception(Kind k) { return std::runtime_error(err_to_str(k)); }
+};
+
+// Only declared here: the definition lives in divide.cpp, which instantiates
+// it for both policies
+template <Expection::Policy P = Expection::DefaultPolicy>
+auto divide_by(int numerator, int denominator)
+    -> Expection::ResultType<double, DivideByError, P>;
+
+EXPECTION_DECLARE_POLICIES(divide_by);
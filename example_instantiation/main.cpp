@@ -0,0 +1,20 @@
+#include <print>
+
+#include "divide.hpp"
+
+int main() {
+  // Both calls link against the instantiations in divide.cpp
+  try {
+    auto ret1 = divide_by<Expection::Policy::Exceptions>(1, 0);
+    std::println("{}", ret1);
+  } catch (std::exception &ex) {
+    std::println("Caught: {}", ex.what());
+  }
+
+  auto ret2 = divide_by<Expection::Policy::Expected>(1, 2);
+  if (ret2.has_value()) {
+    std::println("{}", ret2.value());
+  } else {
+    std::println("Unexpected: {}", ret2.error().str());
+  }
+}
@@ -0,0 +1,253 @@
+// Policy equivalence fuzzer: every input drives divide_by (through each
+// failure method) and a small record parser through Policy::Exceptions,
+// Expected and Compact, which must agree (see Expection/equivalence.hpp). The
+// parser's Error owns heap memory and counts its instances, so that leaks and
+// repeated constructions on the failure path are caught, by the sanitizers or
+// by the counts.
+// Built as a libFuzzer target with EXPECTION_LIBFUZZER, otherwise main()
+// replays the files given as arguments, or -runs=N random inputs
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "Expection.hpp"
+#include "Expection/equivalence.hpp"
+#include "divide_by_fixture.hpp"
+
+#ifndef EXPECTION_LIBFUZZER
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+#endif
+
+using namespace Expection;
+
+// Error owning a heap-allocated description, counting its live instances and
+// the ones constructed from arguments (rather than copied or moved)
+struct RecordError {
+  enum class Kind { Empty, TooLong, BadChecksum };
+
+  static inline int live = 0;
+  static inline int made = 0;
+
+  Kind kind;
+  std::string detail;
+
+  RecordError(Kind k, std::string d) : kind(k), detail(std::move(d)) {
+    ++live;
+    ++made;
+  }
+
+  RecordError(const RecordError &other)
+      : kind(other.kind), detail(other.detail) {
+    ++live;
+  }
+
+  RecordError(RecordError &&other) noexcept
+      : kind(other.kind), detail(std::move(other.detail)) {
+    ++live;
+  }
+
+  RecordError &operator=(const RecordError &) = default;
+  RecordError &operator=(RecordError &&) = default;
+
+  ~RecordError() { --live; }
+
+  static auto exception(Kind, const std::string &detail) {
+    return std::invalid_argument(detail);
+  }
+
+  auto exception() const { return std::invalid_argument(detail); }
+
+  friend bool operator==(const RecordError &, const RecordError &) = default;
+};
+
+// Records are a payload followed by a checksum byte (the sum of the payload's
+// bytes), and parse to the FNV-1a hash of their payload
+inline constexpr std::size_t MaxRecord = 40;
+
+template <Policy P>
+auto parse_record(std::string_view record)
+    -> ResultType<std::uint32_t, RecordError, P> {
+  using Error = RecordError;
+
+  if (record.empty()) {
+    return make_failure<std::uint32_t, Error, P>(Error::Kind::Empty,
+                                                 "empty record");
+  }
+  if (record.size() > MaxRecord) {
+    return failure<std::uint32_t, P>(
+        Error{Error::Kind::TooLong, "record too long: " + std::string(record)});
+  }
+
+  std::uint8_t checksum = 0;
+  std::uint32_t hash = 2166136261u;
+  for (auto byte : record.substr(0, record.size() - 1)) {
+    const auto value = static_cast<std::uint8_t>(byte);
+    checksum = static_cast<std::uint8_t>(checksum + value);
+    hash = (hash ^ value) * 16777619u;
+  }
+  if (checksum != static_cast<std::uint8_t>(record.back())) {
+    return make_failure<std::uint32_t, Error, P>(
+        Error::Kind::BadChecksum,
+        "checksum mismatch in record of " + std::to_string(record.size()) +
+            " bytes, expected " + std::to_string(checksum));
+  }
+  return success<std::uint32_t, RecordError, P>(hash);
+}
+
+// Newline-separated records, stopping at the first invalid one
+template <Policy P>
+auto sum_records(std::string_view records)
+    -> ResultType<std::uint32_t, RecordError, P> {
+  std::uint32_t sum = 0;
+  while (!records.empty()) {
+    auto end = records.find('\n');
+    EXPECTION_TRY_ASSIGN(auto hash, parse_record<P>(records.substr(0, end)));
+    sum += hash;
+    records.remove_prefix(end == std::string_view::npos ? records.size()
+                                                        : end + 1);
+  }
+  return success<std::uint32_t, RecordError, P>(sum);
+}
+
+namespace {
+void check(const char *mismatch, const char *function) {
+  if (mismatch != nullptr) {
+    std::fprintf(stderr, "%s: %s\n", function, mismatch);
+    std::abort();
+  }
+}
+
+// A failure constructs its Error from arguments at most once, under every
+// policy, and nothing on success
+template <Policy P, typename F> void check_constructions(const F &f) {
+  const auto before = RecordError::made;
+  bool failed = false;
+  try {
+    auto result = f.template operator()<P>();
+    if constexpr (ReturnsExpected<P>) {
+      failed = !result.has_value();
+    }
+  } catch (const std::invalid_argument &) {
+    failed = true;
+  }
+  const auto constructions = RecordError::made - before;
+  if (constructions > (failed ? 1 : 0)) {
+    std::fprintf(stderr, "%d RecordError constructions for one %s\n",
+                 constructions, failed ? "failure" : "success");
+    std::abort();
+  }
+}
+
+template <FailureMethod F> void check_divide(int numerator, int denominator) {
+  check(policy_mismatch(
+            []<Policy P>(int a, int b) { return divide_by<F, P>(a, b); },
+            numerator, denominator),
+        "divide_by");
+}
+
+template <typename T>
+auto take(const std::uint8_t *&data, std::size_t &size) -> T {
+  T value{};
+  const auto taken = size < sizeof(T) ? size : sizeof(T);
+  if (taken != 0) {
+    std::memcpy(&value, data, taken);
+  }
+  data += taken;
+  size -= taken;
+  return value;
+}
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data,
+                                      std::size_t size) {
+  // Small denominators, so that 0 comes up often
+  const auto numerator = take<int>(data, size);
+  const auto denominator = static_cast<int>(take<std::int8_t>(data, size)) % 4;
+  check_divide<FailureMethod::InPlace>(numerator, denominator);
+  check_divide<FailureMethod::Functor>(numerator, denominator);
+  check_divide<FailureMethod::Callable>(numerator, denominator);
+  check_divide<FailureMethod::Conversion>(numerator, denominator);
+
+  const std::string_view records(reinterpret_cast<const char *>(data), size);
+  const auto first = records.substr(0, records.find('\n'));
+  check(policy_mismatch(
+            []<Policy P>(std::string_view r) { return parse_record<P>(r); },
+            first),
+        "parse_record");
+  check(policy_mismatch(
+            []<Policy P>(std::string_view r) { return sum_records<P>(r); },
+            records),
+        "sum_records");
+
+  auto sum = [records]<Policy P>() { return sum_records<P>(records); };
+  check_constructions<Policy::Exceptions>(sum);
+  check_constructions<Policy::Expected>(sum);
+  check_constructions<Policy::Compact>(sum);
+
+  if (RecordError::live != 0) {
+    std::fprintf(stderr, "%d RecordErrors leaked\n", RecordError::live);
+    std::abort();
+  }
+  return 0;
+}
+
+#ifndef EXPECTION_LIBFUZZER
+// Random inputs are mostly well-formed records, so that every path is taken
+static auto random_input(std::mt19937 &random) -> std::vector<std::uint8_t> {
+  std::vector<std::uint8_t> input(5);
+  for (auto &byte : input) {
+    byte = static_cast<std::uint8_t>(random());
+  }
+  const auto records = random() % 4;
+  for (std::uint32_t i = 0; i < records; ++i) {
+    const auto length = random() % (MaxRecord + 4);
+    std::uint8_t checksum = 0;
+    for (std::uint32_t j = 0; j < length; ++j) {
+      auto byte = static_cast<std::uint8_t>('a' + random() % 26);
+      checksum = static_cast<std::uint8_t>(checksum + byte);
+      input.push_back(byte);
+    }
+    input.push_back(random() % 8 == 0 ? static_cast<std::uint8_t>(random())
+                                      : checksum);
+    input.push_back('\n');
+  }
+  return input;
+}
+
+int main(int argc, char **argv) {
+  long runs = 0;
+  std::vector<const char *> files;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "-runs=", 6) == 0) {
+      runs = std::strtol(argv[i] + 6, nullptr, 10);
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+
+  for (const auto *file : files) {
+    std::ifstream stream(file, std::ios::binary);
+    const std::vector<std::uint8_t> input(
+        (std::istreambuf_iterator<char>(stream)),
+        std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+
+  std::mt19937 random(20260101);
+  for (long run = 0; run < runs; ++run) {
+    const auto input = random_input(random);
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+  std::printf("%zu files, %ld random inputs\n", files.size(), runs);
+}
+#endif
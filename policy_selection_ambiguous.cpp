@@ -0,0 +1,10 @@
+// Must not compile: testexpection_policies.hpp selects both
+// storage::profiled_lookup and cache::profiled_lookup, so profiled_lookup alone
+// is ambiguous (checked by the policy_selection_ambiguous test)
+#define EXPECTION_SELECTED_POLICIES "testexpection_policies.hpp"
+
+#include "Expection/core.hpp"
+
+constexpr auto policy = EXPECTION_POLICY_FOR(profiled_lookup);
+
+int main() {}
@@ -0,0 +1,128 @@
+// Synthetic workload for the expection_size_report target: SIZE_FUNCTIONS
+// distinct divide_by-style functions per failure method, and a caller of each,
+// all under the policy EXPECTION_SIZE_POLICY. Built once per policy, so that
+// the sections of each binary show the code size cost of that policy
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "Expection.hpp"
+
+#ifndef EXPECTION_SIZE_POLICY
+#define EXPECTION_SIZE_POLICY Expected
+#endif
+
+#ifndef SIZE_FUNCTIONS
+#define SIZE_FUNCTIONS 64
+#endif
+
+struct DivideByError {
+  enum class Kind { DivideByZero };
+
+  Kind kind;
+
+  static constexpr char const *err_to_str(Kind kind) {
+    switch (kind) {
+    case Kind::DivideByZero:
+      return "Division by Zero";
+
+    default:
+      std::unreachable();
+    };
+  }
+
+  auto str() { return err_to_str(kind); }
+
+  // In-place exception construction
+  static auto exception(Kind k) { return std::runtime_error(err_to_str(k)); }
+
+  // Convert to exception
+  auto exception() { return std::runtime_error(err_to_str(kind)); }
+};
+
+struct DivideByErrorFunctor {
+  static auto unexpected(DivideByError::Kind k) {
+    return std::unexpected<DivideByError>(k);
+  }
+
+  static auto exception(DivideByError::Kind k) {
+    return std::runtime_error(DivideByError::err_to_str(k));
+  }
+};
+
+using namespace Expection;
+
+constexpr auto SizePolicy = Policy::EXPECTION_SIZE_POLICY;
+
+enum class FailureMethod { InPlace, Functor, Callable, Conversion };
+
+// N makes every instantiation a distinct function, which identical code
+// folding can't merge
+template <FailureMethod F, std::size_t N, Policy P>
+[[gnu::noinline]] auto divide_by(int numerator, int denominator)
+    -> ResultType<double, DivideByError, P> {
+  using Result = double;
+  using Error = DivideByError;
+
+  if (denominator == 0) {
+    if constexpr (F == FailureMethod::InPlace) {
+      return make_failure<Result, Error, P>(DivideByError::Kind::DivideByZero);
+    } else if constexpr (F == FailureMethod::Functor) {
+      return make_failure<Result, Error, DivideByErrorFunctor, P>(
+          DivideByError::Kind::DivideByZero);
+    } else if constexpr (F == FailureMethod::Callable) {
+      auto make_unexpected = [](DivideByError::Kind k) {
+        return std::unexpected<DivideByError>(k);
+      };
+
+      auto make_exception = [](DivideByError::Kind k) {
+        return std::runtime_error(DivideByError::err_to_str(k));
+      };
+      return make_failure<Result, Error, P>(make_unexpected, make_exception,
+                                            DivideByError::Kind::DivideByZero);
+    } else if constexpr (F == FailureMethod::Conversion) {
+      auto err = DivideByError{DivideByError::Kind::DivideByZero};
+      return failure<Result, P>(err);
+    }
+  }
+
+  return success<Result, Error, P>(static_cast<Result>(numerator + N) /
+                                   denominator);
+}
+
+// Call sites are part of the cost: checking the result under the policies
+// returning errors
+template <FailureMethod F, std::size_t N>
+[[gnu::noinline]] auto call(int numerator, int denominator) -> double {
+  return value_or<SizePolicy>(
+      divide_by<F, N, SizePolicy>(numerator, denominator), 0.0);
+}
+
+using Caller = double (*)(int, int);
+
+template <FailureMethod F, std::size_t... N>
+constexpr auto callers(std::index_sequence<N...>)
+    -> std::array<Caller, sizeof...(N)> {
+  return {&call<F, N>...};
+}
+
+constexpr auto Callers = std::array{
+    callers<FailureMethod::InPlace>(std::make_index_sequence<SIZE_FUNCTIONS>{}),
+    callers<FailureMethod::Functor>(std::make_index_sequence<SIZE_FUNCTIONS>{}),
+    callers<FailureMethod::Callable>(
+        std::make_index_sequence<SIZE_FUNCTIONS>{}),
+    callers<FailureMethod::Conversion>(
+        std::make_index_sequence<SIZE_FUNCTIONS>{}),
+};
+
+int main(int argc, char **) {
+  double sum = 0;
+  for (const auto &method : Callers) {
+    for (auto *caller : method) {
+      sum += caller(argc, argc);
+    }
+  }
+  return sum > 0 ? 0 : 1;
+}
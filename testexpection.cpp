@@ -1,89 +1,64 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <vector>
 
-#include "Expection.hpp"
-
-// Example Error type and required utilities
-// NOTE: This is checking *all* the possible conversion methods from Expection,
-// Realistically, you only need to implement one of them
-// Suggested implementation: `static auto exception(args...)` inside Error class
-
-struct DivideByError {
-  enum class Kind { DivideByZero };
-
-  Kind kind;
-
-  static constexpr char const *err_to_str(Kind kind) {
-    switch (kind) {
-    case Kind::DivideByZero:
-      return "Division by Zero";
-
-    default:
-      std::unreachable();
-    };
-  }
-
-  auto str() { return err_to_str(kind); }
+// Route Policy::Abort failures into a catchable exception, so the abort path
+// can be tested without terminating the test runner
+struct AbortCalled {};
+[[noreturn]] inline void test_abort_handler() { throw AbortCalled{}; }
+#define EXPECTION_ABORT_HANDLER test_abort_handler
 
-  // In-place exception construction
-  static auto exception(Kind k) { return std::runtime_error(err_to_str(k)); }
+// Count every failure made by the tests, sample their sites, feed them to the
+// circuit breakers and profile them
+#define EXPECTION_TELEMETRY
+#define EXPECTION_SAMPLE_FAILURES
+#define EXPECTION_CIRCUIT_BREAKER
+#define EXPECTION_PROFILE
+#define EXPECTION_SELECTED_POLICIES "testexpection_policies.hpp"
 
-  // Convert to exception
-  auto exception() { return std::runtime_error(err_to_str(kind)); }
-};
+#include "Expection.hpp"
+#include "Expection/batch.hpp"
+#include "Expection/equivalence.hpp"
+#include "Expection/error_map.hpp"
+#include "Expection/future.hpp"
+#include "Expection/parallel.hpp"
+#include "Expection/task.hpp"
+#include "divide_by_fixture.hpp"
 
-struct DivideByErrorFunctor {
-  static auto unexpected(DivideByError::Kind k) {
-    return std::unexpected<DivideByError>(k);
-  }
+// Found by argument-dependent lookup, in code that doesn't use the namespace
+TEST_CASE("pipelines compose without using namespace Expection") {
+  auto triple = [](int x) { return std::expected<int, DivideByError>(x * 3); };
+  auto expected = Expection::pipe(std::expected<int, DivideByError>(2)) |
+                  Expection::then(triple) |
+                  Expection::map([](int x) { return x + 1; });
+  CHECK(*expected == 7);
 
-  static auto exception(DivideByError::Kind k) {
-    return std::runtime_error(DivideByError::err_to_str(k));
-  }
-};
+  auto plain = Expection::pipe(2) | Expection::map([](int x) { return x * 2; });
+  CHECK(plain == 4);
+}
 
 using namespace Expection;
 
-// Testing class
-// NOTE: we are only using "FailureMethod" as a template parameter for our unit
-// tests, For actual use of the library, you'd just choose one and only have
-// Policy as the template parameter
-enum class FailureMethod { InPlace, Functor, Callable, Conversion };
-
-template <FailureMethod F, Policy P = DefaultPolicy>
-auto divide_by(int numerator, int denominator)
-    -> ResultType<double, DivideByError, P> {
-  using Result = double;
-  using Error = DivideByError;
-
-  if (denominator == 0) {
-    if constexpr (F == FailureMethod::InPlace) {
-      return make_failure<Result, Error, P>(DivideByError::Kind::DivideByZero);
-    } else if constexpr (F == FailureMethod::Functor) {
-      return make_failure<Result, Error, DivideByErrorFunctor, P>(
-          DivideByError::Kind::DivideByZero);
-    } else if constexpr (F == FailureMethod::Callable) {
-      auto make_unexpected = [](DivideByError::Kind k) {
-        return std::unexpected<DivideByError>(k);
-      };
-
-      auto make_exception = [](DivideByError::Kind k) {
-        return std::runtime_error(DivideByError::err_to_str(k));
-      };
-      return make_failure<Result, Error, P>(make_unexpected, make_exception,
-                                            DivideByError::Kind::DivideByZero);
-    } else if constexpr (F == FailureMethod::Conversion) {
-      auto err = DivideByError{DivideByError::Kind::DivideByZero};
-      return failure<Result, P>(err);
-    }
-  }
-
-  return success<Result, Error, P>(static_cast<Result>(numerator) /
-                                   denominator);
-}
+// Explicit instantiations, with a template argument preceding the Policy
+EXPECTION_DECLARE_POLICIES(divide_by, FailureMethod::InPlace);
+EXPECTION_INSTANTIATE_POLICIES(divide_by, FailureMethod::InPlace);
+EXPECTION_INSTANTIATE_POLICY(Abort, divide_by, FailureMethod::InPlace);
 
 TEST_CASE_TEMPLATE(
     "divide_by with Expected policy", F,
@@ -133,6 +108,61 @@ TEST_CASE_TEMPLATE(
   }
 }
 
+TEST_CASE_TEMPLATE(
+    "divide_by with Abort policy", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  constexpr auto FailMethod = F::value;
+
+  static_assert(std::is_same_v<
+                decltype(divide_by<FailMethod, Policy::Abort>(1, 2)), double>);
+
+  SUBCASE("success case") {
+    auto result = divide_by<FailMethod, Policy::Abort>(1, 2);
+    CHECK(result == doctest::Approx(0.5));
+  }
+
+  SUBCASE("failure case") {
+    bool handler_called = false;
+    try {
+      divide_by<FailMethod, Policy::Abort>(1, 0);
+    } catch (const AbortCalled &) {
+      handler_called = true;
+    }
+    CHECK(handler_called);
+  }
+}
+
+TEST_CASE_TEMPLATE(
+    "divide_by with Unchecked policy", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  constexpr auto FailMethod = F::value;
+
+  static_assert(
+      std::is_same_v<decltype(divide_by<FailMethod, Policy::Unchecked>(1, 2)),
+                     double>);
+
+  auto result = divide_by<FailMethod, Policy::Unchecked>(1, 2);
+  CHECK(result == doctest::Approx(0.5));
+
+#ifndef NDEBUG
+  SUBCASE("failure case is checked in debug builds") {
+    bool handler_called = false;
+    try {
+      divide_by<FailMethod, Policy::Unchecked>(1, 0);
+    } catch (const AbortCalled &) {
+      handler_called = true;
+    }
+    CHECK(handler_called);
+  }
+#endif
+}
+
 TEST_CASE_TEMPLATE(
     "divide_by with default policy", F,
     std::integral_constant<FailureMethod, FailureMethod::InPlace>,
@@ -159,3 +189,1965 @@ TEST_CASE_TEMPLATE(
     CHECK(exception_message == "Division by Zero");
   }
 }
+
+// Copy/move accounting for success(): counted at compile time, so the
+// guarantees below are checked by static_assert
+struct CopyMoveCounts {
+  int copies = 0;
+  int moves = 0;
+};
+
+struct Tracked {
+  CopyMoveCounts *counts;
+
+  constexpr explicit Tracked(CopyMoveCounts *c) : counts(c) {}
+  constexpr Tracked(const Tracked &other) : counts(other.counts) {
+    ++counts->copies;
+  }
+  constexpr Tracked(Tracked &&other) noexcept : counts(other.counts) {
+    ++counts->moves;
+  }
+};
+
+template <Policy P> constexpr auto count_success_rvalue() {
+  CopyMoveCounts counts;
+  auto result = success<Tracked, NoError, P>(Tracked{&counts});
+  (void)result;
+  return counts;
+}
+
+template <Policy P> constexpr auto count_success_in_place() {
+  CopyMoveCounts counts;
+  auto result = success_in_place<Tracked, NoError, P>(&counts);
+  (void)result;
+  return counts;
+}
+
+static_assert(count_success_rvalue<Policy::Exceptions>().copies == 0);
+static_assert(count_success_rvalue<Policy::Exceptions>().moves <= 1);
+static_assert(count_success_rvalue<Policy::Expected>().copies == 0);
+static_assert(count_success_rvalue<Policy::Expected>().moves <= 1);
+
+static_assert(count_success_in_place<Policy::Exceptions>().copies == 0);
+static_assert(count_success_in_place<Policy::Exceptions>().moves == 0);
+static_assert(count_success_in_place<Policy::Expected>().copies == 0);
+static_assert(count_success_in_place<Policy::Expected>().moves == 0);
+
+TEST_CASE_TEMPLATE("success with move-only payload", P,
+                   std::integral_constant<Policy, Policy::Exceptions>,
+                   std::integral_constant<Policy, Policy::Expected>) {
+  constexpr auto Pol = P::value;
+
+  SUBCASE("forwarded") {
+    auto ptr = std::make_unique<int>(42);
+    auto result = success<std::unique_ptr<int>, DivideByError, Pol>(
+        std::move(ptr));
+    if constexpr (Pol == Policy::Exceptions) {
+      CHECK(*result == 42);
+    } else {
+      REQUIRE(result.has_value());
+      CHECK(**result == 42);
+    }
+  }
+
+  SUBCASE("in place") {
+    auto result = success_in_place<std::vector<int>, DivideByError, Pol>(
+        std::size_t{3}, 7);
+    if constexpr (Pol == Policy::Exceptions) {
+      CHECK(result == std::vector<int>{7, 7, 7});
+    } else {
+      REQUIRE(result.has_value());
+      CHECK(*result == std::vector<int>{7, 7, 7});
+    }
+  }
+
+  SUBCASE("deduced") {
+    auto result = success(std::string("abc"));
+    static_assert(std::is_same_v<decltype(result),
+                                 ResultType<std::string, NoError>>);
+  }
+}
+
+// Error type whose exceptions are built once and rethrown on every failure
+struct PreallocatedDivideByError {
+  enum class Kind { DivideByZero, Overflow };
+
+  Kind kind;
+
+  static constexpr char const *err_to_str(Kind kind) {
+    switch (kind) {
+    case Kind::DivideByZero:
+      return "Division by Zero";
+    case Kind::Overflow:
+      return "Overflow";
+
+    default:
+      std::unreachable();
+    };
+  }
+
+  static decltype(auto) exception_ptr(Kind k) {
+    return preallocated_exception<std::runtime_error, err_to_str, 2>(k);
+  }
+};
+
+template <Policy P>
+auto preallocated_divide_by(int numerator, int denominator)
+    -> ResultType<double, PreallocatedDivideByError, P> {
+  using Error = PreallocatedDivideByError;
+
+  if (denominator == 0) {
+    return make_failure<double, Error, P>(Error::Kind::DivideByZero);
+  }
+  return success<double, Error, P>(static_cast<double>(numerator) /
+                                   denominator);
+}
+
+TEST_CASE("make_failure with preallocated exceptions") {
+  SUBCASE("Exceptions policy rethrows the same object") {
+    const std::exception *first = nullptr;
+    const std::exception *second = nullptr;
+    std::string message;
+
+    try {
+      preallocated_divide_by<Policy::Exceptions>(1, 0);
+    } catch (const std::runtime_error &ex) {
+      first = &ex;
+      message = ex.what();
+    }
+    try {
+      preallocated_divide_by<Policy::Exceptions>(1, 0);
+    } catch (const std::runtime_error &ex) {
+      second = &ex;
+    }
+
+    REQUIRE(first != nullptr);
+    CHECK(first == second);
+    CHECK(message == "Division by Zero");
+  }
+
+  SUBCASE("one exception per kind") {
+    using Kind = PreallocatedDivideByError::Kind;
+    auto &overflow = PreallocatedDivideByError::exception_ptr(Kind::Overflow);
+    auto &divide = PreallocatedDivideByError::exception_ptr(Kind::DivideByZero);
+    CHECK(overflow != divide);
+
+    std::string message;
+    try {
+      std::rethrow_exception(overflow);
+    } catch (const std::runtime_error &ex) {
+      message = ex.what();
+    }
+    CHECK(message == "Overflow");
+  }
+
+  SUBCASE("kinds out of the table abort") {
+    CHECK_THROWS_AS(PreallocatedDivideByError::exception_ptr(
+                        static_cast<PreallocatedDivideByError::Kind>(2)),
+                    AbortCalled);
+  }
+
+  SUBCASE("Expected policy is unaffected") {
+    auto result = preallocated_divide_by<Policy::Expected>(1, 0);
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().kind == PreallocatedDivideByError::Kind::DivideByZero);
+  }
+}
+
+// Compact error codes
+enum class MathErrc { DivideByZero, Overflow };
+
+constexpr char const *err_to_str(MathErrc kind) {
+  switch (kind) {
+  case MathErrc::DivideByZero:
+    return "Division by Zero";
+  case MathErrc::Overflow:
+    return "Overflow";
+
+  default:
+    std::unreachable();
+  };
+}
+
+// Returned in registers under the SysV ABI: at most two eightbytes, and
+// trivial for the purposes of calls
+template <typename T>
+inline constexpr bool passed_in_registers =
+    sizeof(T) <= 16 && std::is_trivially_copy_constructible_v<T> &&
+    std::is_trivially_move_constructible_v<T> &&
+    std::is_trivially_destructible_v<T>;
+
+static_assert(sizeof(ErrorCode<MathErrc>) == 4);
+static_assert(sizeof(ErrorCode<MathErrc, std::uint32_t>) == 8);
+static_assert(std::is_trivially_copyable_v<ErrorCode<MathErrc>>);
+static_assert(std::is_trivially_copyable_v<ErrorCode<MathErrc, std::uint32_t>>);
+static_assert(
+    passed_in_registers<ResultType<int, ErrorCode<MathErrc>, Policy::Expected>>);
+static_assert(ExceptionConstructable<ErrorCode<MathErrc>, MathErrc>);
+static_assert(ExceptionConvertible<ErrorCode<MathErrc> &>);
+static_assert(
+    ErrorFunctor<ErrorCode<MathErrc>, ErrorCode<MathErrc>, MathErrc>);
+static_assert(passed_in_registers<
+              ResultType<int, ErrorCode<MathErrc, std::uint32_t>,
+                         Policy::Expected>>);
+
+template <FailureMethod F, Policy P>
+auto checked_divide(int numerator, int denominator)
+    -> ResultType<int, ErrorCode<MathErrc, std::uint32_t>, P> {
+  using Result = int;
+  using Error = ErrorCode<MathErrc, std::uint32_t>;
+  auto payload = static_cast<std::uint32_t>(numerator);
+
+  if (denominator == 0) {
+    if constexpr (F == FailureMethod::InPlace) {
+      return make_failure<Result, Error, P>(MathErrc::DivideByZero, payload);
+    } else if constexpr (F == FailureMethod::Functor) {
+      return make_failure<Result, Error, Error, P>(MathErrc::DivideByZero,
+                                                   payload);
+    } else if constexpr (F == FailureMethod::Callable) {
+      return make_failure<Result, Error, P>(
+          [](MathErrc k, std::uint32_t p) { return Error::unexpected(k, p); },
+          [](MathErrc k, std::uint32_t p) { return Error::exception(k, p); },
+          MathErrc::DivideByZero, payload);
+    } else if constexpr (F == FailureMethod::Conversion) {
+      return failure<Result, P>(Error{MathErrc::DivideByZero, payload});
+    }
+  }
+
+  return success<Result, Error, P>(numerator / denominator);
+}
+
+TEST_CASE_TEMPLATE(
+    "ErrorCode as Error type", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  constexpr auto FailMethod = F::value;
+
+  SUBCASE("Expected policy") {
+    auto ok = checked_divide<FailMethod, Policy::Expected>(6, 3);
+    REQUIRE(ok.has_value());
+    CHECK(*ok == 2);
+
+    auto result = checked_divide<FailMethod, Policy::Expected>(7, 0);
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().kind == MathErrc::DivideByZero);
+    CHECK(result.error().payload == 7);
+    CHECK(std::string(result.error().str()) == "Division by Zero");
+  }
+
+  SUBCASE("Exceptions policy") {
+    std::string exception_message;
+    try {
+      checked_divide<FailMethod, Policy::Exceptions>(7, 0);
+    } catch (const std::runtime_error &ex) {
+      exception_message = ex.what();
+    }
+    CHECK(exception_message == "Division by Zero");
+  }
+}
+
+// Pipelines: written once, for every policy
+template <Policy P> auto halve_then_divide(int numerator, int denominator) {
+  return pipe(divide_by<FailureMethod::InPlace, P>(numerator, denominator)) |
+         map([](double value) { return value / 2; }) |
+         then([](double value) {
+           return divide_by<FailureMethod::InPlace, P>(
+               static_cast<int>(value * 100), 5);
+         });
+}
+
+TEST_CASE_TEMPLATE("pipeline combinators", P,
+                   std::integral_constant<Policy, Policy::Exceptions>,
+                   std::integral_constant<Policy, Policy::Expected>) {
+  constexpr auto Pol = P::value;
+  static_assert(std::is_same_v<decltype(halve_then_divide<Pol>(1, 1)),
+                               ResultType<double, DivideByError, Pol>>);
+
+  SUBCASE("success case") {
+    auto result = halve_then_divide<Pol>(1, 1);
+    if constexpr (Pol == Policy::Expected) {
+      REQUIRE(result.has_value());
+      CHECK(*result == doctest::Approx(10));
+    } else {
+      CHECK(result == doctest::Approx(10));
+    }
+  }
+
+  SUBCASE("failure case") {
+    if constexpr (Pol == Policy::Expected) {
+      auto result = halve_then_divide<Pol>(1, 0);
+      REQUIRE_FALSE(result.has_value());
+      CHECK(std::string(result.error().str()) == "Division by Zero");
+    } else {
+      bool exception_thrown = false;
+      try {
+        halve_then_divide<Pol>(1, 0);
+      } catch (const std::runtime_error &) {
+        exception_thrown = true;
+      }
+      CHECK(exception_thrown);
+    }
+  }
+
+  SUBCASE("error handling steps") {
+    auto recovered =
+        pipe(divide_by<FailureMethod::InPlace, Pol>(1, 2)) |
+        map_error([](DivideByError err) { return std::string(err.str()); }) |
+        or_else([](const std::string &) {
+          return success<double, std::string, Pol>(-1.0);
+        });
+    static_assert(std::is_same_v<decltype(recovered),
+                                 ResultType<double, std::string, Pol>>);
+
+    if constexpr (Pol == Policy::Expected) {
+      REQUIRE(recovered.has_value());
+      CHECK(*recovered == doctest::Approx(0.5));
+
+      auto failed =
+          pipe(divide_by<FailureMethod::InPlace, Pol>(1, 0)) |
+          map_error([](DivideByError err) { return std::string(err.str()); });
+      REQUIRE_FALSE(failed.has_value());
+      CHECK(failed.error() == "Division by Zero");
+
+      auto fallback = pipe(divide_by<FailureMethod::InPlace, Pol>(1, 0)) |
+                      or_else([](DivideByError) {
+                        return success<double, DivideByError, Pol>(-1.0);
+                      });
+      REQUIRE(fallback.has_value());
+      CHECK(*fallback == doctest::Approx(-1));
+    } else {
+      CHECK(recovered == doctest::Approx(0.5));
+    }
+  }
+}
+
+// Error propagation
+template <Policy P>
+auto sum_of_quotients(int numerator, int first, int second)
+    -> ResultType<double, DivideByError, P> {
+  auto a = EXPECTION_TRY(divide_by<FailureMethod::InPlace, P>(numerator, first));
+  EXPECTION_TRY_ASSIGN(auto b, divide_by<FailureMethod::InPlace, P>(
+                                   numerator, second));
+  return success<double, DivideByError, P>(a + b);
+}
+
+template <Policy P>
+auto check_nonzero(int value) -> ResultType<void, DivideByError, P> {
+  if (value == 0) {
+    return make_failure<void, DivideByError, P>(
+        DivideByError::Kind::DivideByZero);
+  }
+  return success<DivideByError, P>();
+}
+
+template <Policy P>
+auto checked_inverse(int value) -> ResultType<double, DivideByError, P> {
+  EXPECTION_TRY(check_nonzero<P>(value));
+  return success<double, DivideByError, P>(1.0 / value);
+}
+
+// Not a template: the propagation must still compile under Exceptions
+auto sum_of_quotients_throwing(int numerator, int first, int second)
+    -> double {
+  auto a = EXPECTION_TRY(
+      divide_by<FailureMethod::InPlace, Policy::Exceptions>(numerator, first));
+  auto b = EXPECTION_TRY(
+      divide_by<FailureMethod::InPlace, Policy::Exceptions>(numerator, second));
+  return a + b;
+}
+
+// The propagated error is moved, never copied
+constexpr auto failing_tracked(CopyMoveCounts *counts)
+    -> std::expected<int, Tracked> {
+  return std::unexpected<Tracked>(std::in_place, counts);
+}
+
+constexpr auto propagate_tracked(CopyMoveCounts *counts)
+    -> std::expected<int, Tracked> {
+  EXPECTION_TRY_ASSIGN(int value, failing_tracked(counts));
+  return value;
+}
+
+constexpr auto count_try_propagation() {
+  CopyMoveCounts counts;
+  auto result = propagate_tracked(&counts);
+  (void)result;
+  return counts;
+}
+
+static_assert(count_try_propagation().copies == 0);
+
+TEST_CASE_TEMPLATE("EXPECTION_TRY propagation", P,
+                   std::integral_constant<Policy, Policy::Exceptions>,
+                   std::integral_constant<Policy, Policy::Expected>) {
+  constexpr auto Pol = P::value;
+
+  SUBCASE("success case") {
+    auto result = sum_of_quotients<Pol>(1, 2, 4);
+    auto inverse = checked_inverse<Pol>(4);
+    if constexpr (Pol == Policy::Expected) {
+      REQUIRE(result.has_value());
+      CHECK(*result == doctest::Approx(0.75));
+      REQUIRE(inverse.has_value());
+      CHECK(*inverse == doctest::Approx(0.25));
+    } else {
+      CHECK(result == doctest::Approx(0.75));
+      CHECK(inverse == doctest::Approx(0.25));
+    }
+  }
+
+  SUBCASE("failure case") {
+    if constexpr (Pol == Policy::Expected) {
+      auto first = sum_of_quotients<Pol>(1, 0, 4);
+      auto second = sum_of_quotients<Pol>(1, 2, 0);
+      auto inverse = checked_inverse<Pol>(0);
+      REQUIRE_FALSE(first.has_value());
+      REQUIRE_FALSE(second.has_value());
+      REQUIRE_FALSE(inverse.has_value());
+      CHECK(std::string(second.error().str()) == "Division by Zero");
+    } else {
+      int exceptions_thrown = 0;
+      try {
+        sum_of_quotients<Pol>(1, 2, 0);
+      } catch (const std::runtime_error &) {
+        ++exceptions_thrown;
+      }
+      try {
+        checked_inverse<Pol>(0);
+      } catch (const std::runtime_error &) {
+        ++exceptions_thrown;
+      }
+      CHECK(exceptions_thrown == 2);
+    }
+  }
+}
+
+TEST_CASE("EXPECTION_TRY outside of templates") {
+  CHECK(sum_of_quotients_throwing(1, 2, 4) == doctest::Approx(0.75));
+  bool exception_thrown = false;
+  try {
+    sum_of_quotients_throwing(1, 0, 4);
+  } catch (const std::runtime_error &) {
+    exception_thrown = true;
+  }
+  CHECK(exception_thrown);
+}
+
+// Batches
+template <Policy P>
+auto divide_batch(std::span<double> out, const std::vector<int> &numerators,
+                  const std::vector<int> &denominators) {
+  return transform_batch<double, DivideByError, P>(
+      out,
+      [](double &value, int numerator, int denominator) {
+        value = static_cast<double>(numerator) / denominator;
+        return denominator != 0;
+      },
+      [](int, int) { return DivideByError{DivideByError::Kind::DivideByZero}; },
+      numerators, denominators);
+}
+
+TEST_CASE("transform_batch") {
+  // Spans several bitmap words, with a partial last one
+  const std::size_t size = 150;
+  std::vector<int> numerators(size);
+  std::vector<int> denominators(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    numerators[i] = static_cast<int>(i);
+    denominators[i] = (i == 3 || i == 64 || i == 149) ? 0 : 2;
+  }
+  std::vector<double> out(size);
+
+  SUBCASE("Expected policy collects every error") {
+    auto result = divide_batch<Policy::Expected>(out, numerators, denominators);
+    REQUIRE(result.size() == size);
+    CHECK_FALSE(result.all_valid());
+    REQUIRE(result.error_count() == 3);
+    CHECK(result.errors()[0].first == 3);
+    CHECK(result.errors()[1].first == 64);
+    CHECK(result.errors()[2].first == 149);
+
+    CHECK(result.has_value(2));
+    CHECK_FALSE(result.has_value(64));
+    CHECK(result.error(2) == nullptr);
+    REQUIRE(result.error(149) != nullptr);
+    CHECK(result.error(149)->kind == DivideByError::Kind::DivideByZero);
+    CHECK(result.values()[10] == doctest::Approx(5));
+    CHECK(result.validity().size() == 3);
+  }
+
+  SUBCASE("Expected policy without errors") {
+    std::fill(denominators.begin(), denominators.end(), 4);
+    auto result = divide_batch<Policy::Expected>(out, numerators, denominators);
+    CHECK(result.all_valid());
+    CHECK(result.values()[148] == doctest::Approx(37));
+  }
+
+  SUBCASE("Exceptions policy throws the first error") {
+    bool exception_thrown = false;
+    try {
+      divide_batch<Policy::Exceptions>(out, numerators, denominators);
+    } catch (const std::runtime_error &) {
+      exception_thrown = true;
+    }
+    CHECK(exception_thrown);
+
+    std::fill(denominators.begin(), denominators.end(), 4);
+    auto result =
+        divide_batch<Policy::Exceptions>(out, numerators, denominators);
+    CHECK(result.all_valid());
+    CHECK(result.has_value(64));
+    CHECK(result.values()[64] == doctest::Approx(16));
+  }
+}
+
+// Dynamic policy: compiled once, resolved to the caller's policy
+auto library_divide(int numerator, int denominator)
+    -> ResultType<double, DivideByError, Policy::Dynamic> {
+  return divide_by<FailureMethod::InPlace, Policy::Dynamic>(numerator,
+                                                            denominator);
+}
+
+auto library_check(int value)
+    -> ResultType<void, DivideByError, Policy::Dynamic> {
+  if (value == 0) {
+    return make_failure<void, DivideByError, Policy::Dynamic>(
+        DivideByError::Kind::DivideByZero);
+  }
+  return success<DivideByError, Policy::Dynamic>();
+}
+
+template <Policy P = DefaultPolicy>
+auto client_divide(int numerator, int denominator)
+    -> ResultType<double, DivideByError, P> {
+  return resolve<P>(library_divide(numerator, denominator));
+}
+
+template <Policy P = DefaultPolicy>
+auto client_check(int value) -> ResultType<void, DivideByError, P> {
+  return resolve<P>(library_check(value));
+}
+
+TEST_CASE_TEMPLATE(
+    "divide_by with Dynamic policy", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  constexpr auto FailMethod = F::value;
+
+  auto ok = divide_by<FailMethod, Policy::Dynamic>(1, 2);
+  REQUIRE(ok.has_value());
+  CHECK(*ok == doctest::Approx(0.5));
+
+  auto result = divide_by<FailMethod, Policy::Dynamic>(1, 0);
+  REQUIRE_FALSE(result.has_value());
+  CHECK(std::string(result.error().str()) == "Division by Zero");
+}
+
+// Error with a static exception(Kind) only, as in the README
+struct KindOnlyError {
+  enum class Kind { Busy };
+
+  Kind kind;
+
+  static auto exception(Kind) { return std::runtime_error("Busy"); }
+};
+
+auto library_acquire(bool busy)
+    -> ResultType<int, KindOnlyError, Policy::Dynamic> {
+  if (busy) {
+    return make_failure<int, KindOnlyError, Policy::Dynamic>(
+        KindOnlyError::Kind::Busy);
+  }
+  return success<int, KindOnlyError, Policy::Dynamic>(1);
+}
+
+TEST_CASE("resolve Dynamic results to the caller's policy") {
+  SUBCASE("Expected") {
+    auto result = client_divide<Policy::Expected>(1, 0);
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().kind == DivideByError::Kind::DivideByZero);
+    CHECK(client_check<Policy::Expected>(1).has_value());
+  }
+
+  SUBCASE("Exceptions") {
+    CHECK(client_divide<Policy::Exceptions>(1, 2) == doctest::Approx(0.5));
+    int exceptions_thrown = 0;
+    try {
+      client_divide<Policy::Exceptions>(1, 0);
+    } catch (const std::runtime_error &) {
+      ++exceptions_thrown;
+    }
+    try {
+      client_check<Policy::Exceptions>(0);
+    } catch (const std::runtime_error &) {
+      ++exceptions_thrown;
+    }
+    CHECK(exceptions_thrown == 2);
+  }
+
+  SUBCASE("Exceptions from the static factory") {
+    CHECK(resolve<Policy::Exceptions>(library_acquire(false)) == 1);
+    CHECK_THROWS_WITH_AS(resolve<Policy::Exceptions>(library_acquire(true)),
+                         "Busy", std::runtime_error);
+  }
+
+  SUBCASE("Abort") {
+    CHECK(client_divide<Policy::Abort>(1, 2) == doctest::Approx(0.5));
+    bool handler_called = false;
+    try {
+      client_divide<Policy::Abort>(1, 0);
+    } catch (const AbortCalled &) {
+      handler_called = true;
+    }
+    CHECK(handler_called);
+  }
+}
+
+TEST_CASE("transform_batch throws the exception of a kind-only Error") {
+  const std::vector<int> pending{0, 3, 1};
+  std::vector<int> out(pending.size());
+  auto acquire = [&] {
+    return transform_batch<int, KindOnlyError, Policy::Exceptions>(
+        std::span<int>(out),
+        [](int &slot, int queued) {
+          slot = queued;
+          return queued < 2;
+        },
+        [](int) { return KindOnlyError{KindOnlyError::Kind::Busy}; }, pending);
+  };
+  CHECK_THROWS_WITH_AS(acquire(), "Busy", std::runtime_error);
+}
+
+// === Telemetry ===
+
+enum class CountedErrc { First, Second };
+
+constexpr char const *err_to_str(CountedErrc kind) {
+  switch (kind) {
+  case CountedErrc::First:
+    return "First";
+  case CountedErrc::Second:
+    return "Second";
+  default:
+    std::unreachable();
+  }
+}
+
+using CountedError = ErrorCode<CountedErrc>;
+
+TEST_CASE("failures are counted per Error type and kind") {
+  const auto before_first = telemetry::failure_count<CountedError>(
+      CountedErrc::First);
+  const auto before_second = telemetry::failure_count<CountedError>(
+      CountedErrc::Second);
+
+  // Made in place (kind is the argument) or converted (kind is the member)
+  auto made = make_failure<int, CountedError, Policy::Expected>(
+      CountedErrc::Second);
+  CHECK_FALSE(made.has_value());
+  auto converted =
+      failure<int, Policy::Expected>(CountedError{CountedErrc::First});
+  CHECK_FALSE(converted.has_value());
+
+  // Aggregated over every thread, including ones that already exited
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 100; ++i) {
+        (void)make_failure<int, CountedError, CountedError, Policy::Expected>(
+            CountedErrc::Second);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  CHECK(telemetry::failure_count<CountedError>(CountedErrc::First) -
+            before_first ==
+        1);
+  CHECK(telemetry::failure_count<CountedError>(CountedErrc::Second) -
+            before_second ==
+        401);
+  CHECK(telemetry::failure_count<CountedError>() >= 402);
+
+  // Successes aren't counted
+  auto ok = success<int, CountedError, Policy::Expected>(1);
+  CHECK(ok.has_value());
+  CHECK(telemetry::failure_count<CountedError>(CountedErrc::Second) -
+            before_second ==
+        401);
+}
+
+TEST_CASE("resolve doesn't count a Dynamic failure twice") {
+  const auto before = telemetry::failure_count<DivideByError>();
+  CHECK_FALSE(client_divide<Policy::Expected>(1, 0).has_value());
+  CHECK_THROWS_AS(client_divide<Policy::Exceptions>(1, 0), std::runtime_error);
+  CHECK(telemetry::failure_count<DivideByError>() - before == 2);
+}
+
+// === Failure site sampling ===
+
+TEST_CASE("failure sites are sampled into the ring buffer") {
+  sampling::set_sample_every(1);
+
+  const auto line = std::source_location::current().line() + 1;
+  auto converted = failure<int, Policy::Expected>(CountedError{CountedErrc::First});
+  CHECK_FALSE(converted.has_value());
+  const auto made_line = std::source_location::current().line() + 1;
+  auto made = make_failure<int, CountedError, Policy::Expected>(
+      CountedErrc::Second);
+  CHECK_FALSE(made.has_value());
+  const auto here = std::source_location::current();
+  auto located = make_failure_at<int, CountedError, Policy::Expected>(
+      here, CountedErrc::Second);
+  CHECK_FALSE(located.has_value());
+
+  std::vector<sampling::FailureSample> samples;
+  sampling::for_each_sample(
+      [&](const sampling::FailureSample &sample) { samples.push_back(sample); });
+  REQUIRE(samples.size() >= 3);
+
+  // failure(), make_failure() and make_failure_at() report their caller's
+  // location
+  const auto &at_failure = samples[samples.size() - 3];
+  const auto &at_make_failure = samples[samples.size() - 2];
+  CHECK(at_failure.line == line);
+  CHECK(std::string_view(at_failure.file).ends_with("testexpection.cpp"));
+  CHECK(at_failure.return_address != 0);
+  CHECK(at_make_failure.line == made_line);
+  CHECK(std::string_view(at_make_failure.file).ends_with("testexpection.cpp"));
+  CHECK(at_make_failure.return_address != 0);
+  CHECK(at_make_failure.sequence == at_failure.sequence + 1);
+  CHECK(samples.back().line == here.line());
+  CHECK(std::string_view(samples.back().function) == here.function_name());
+
+  // With a rate of N, one failure in N is sampled
+  sampling::set_sample_every(4);
+  std::size_t before = 0;
+  sampling::for_each_sample([&](const sampling::FailureSample &sample) {
+    before = sample.sequence;
+  });
+  for (int i = 0; i < 8; ++i) {
+    (void)make_failure<int, CountedError, Policy::Expected>(CountedErrc::First);
+  }
+  std::size_t after = 0;
+  sampling::for_each_sample([&](const sampling::FailureSample &sample) {
+    after = sample.sequence;
+  });
+  CHECK(after - before == 2);
+
+#if __has_include(<unistd.h>)
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+  sampling::set_sample_every(1);
+  (void)failure<int, Policy::Expected>(CountedError{CountedErrc::First});
+  sampling::dump(fds[1]);
+  close(fds[1]);
+  std::string dumped;
+  char buffer[256];
+  for (ssize_t n; (n = read(fds[0], buffer, sizeof(buffer))) > 0;) {
+    dumped.append(buffer, static_cast<std::size_t>(n));
+  }
+  close(fds[0]);
+  CHECK(dumped.find("testexpection.cpp:") != std::string::npos);
+  CHECK(dumped.find(" stack=0x") != std::string::npos);
+#endif
+
+  sampling::set_sample_every(EXPECTION_SAMPLE_EVERY);
+}
+
+// === Compact results ===
+
+enum class UserId : std::uint32_t {};
+
+template <>
+struct Expection::niche<UserId>
+    : Expection::reserved_values<UserId, UserId{0xffffff00}, 256> {};
+
+static_assert(sizeof(ResultType<int *, ErrorCode<MathErrc>, Policy::Compact>) ==
+              sizeof(int *));
+static_assert(sizeof(ResultType<UserId, MathErrc, Policy::Compact>) ==
+              sizeof(UserId));
+static_assert(sizeof(ResultType<UserId, ErrorCode<MathErrc>, Policy::Compact>) ==
+              sizeof(UserId));
+// No spare values (or an error with a payload): same as std::expected
+static_assert(std::is_same_v<ResultType<int, MathErrc, Policy::Compact>,
+                             std::expected<int, MathErrc>>);
+static_assert(
+    std::is_same_v<
+        ResultType<int *, ErrorCode<MathErrc, std::uint32_t>, Policy::Compact>,
+        std::expected<int *, ErrorCode<MathErrc, std::uint32_t>>>);
+
+template <FailureMethod F, Policy P>
+auto element_at(int *values, int size, int index)
+    -> ResultType<int *, ErrorCode<MathErrc>, P> {
+  using Result = int *;
+  using Error = ErrorCode<MathErrc>;
+
+  if (index < 0 || index >= size) {
+    if constexpr (F == FailureMethod::InPlace) {
+      return make_failure<Result, Error, P>(MathErrc::Overflow);
+    } else if constexpr (F == FailureMethod::Functor) {
+      return make_failure<Result, Error, Error, P>(MathErrc::Overflow);
+    } else if constexpr (F == FailureMethod::Callable) {
+      return make_failure<Result, Error, P>(
+          [](MathErrc k) { return Error::unexpected(k); },
+          [](MathErrc k) { return Error::exception(k); }, MathErrc::Overflow);
+    } else if constexpr (F == FailureMethod::Conversion) {
+      return failure<Result, P>(Error{MathErrc::Overflow});
+    }
+  }
+
+  return success<Result, Error, P>(values + index);
+}
+
+TEST_CASE_TEMPLATE(
+    "Compact policy stores errors in spare values", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  constexpr auto FailMethod = F::value;
+  int values[] = {1, 2, 3};
+
+  auto ok = element_at<FailMethod, Policy::Compact>(values, 3, 1);
+  REQUIRE(ok.has_value());
+  CHECK(*ok == &values[1]);
+  CHECK(*ok.value() == 2);
+
+  auto result = element_at<FailMethod, Policy::Compact>(values, 3, 3);
+  REQUIRE_FALSE(result.has_value());
+  CHECK(result.error().kind == MathErrc::Overflow);
+  CHECK(result.value_or(nullptr) == nullptr);
+  CHECK_THROWS_AS(result.value(),
+                  std::bad_expected_access<ErrorCode<MathErrc>>);
+}
+
+TEST_CASE("Compact results with reserved values") {
+  using Result = ResultType<UserId, MathErrc, Policy::Compact>;
+
+  Result ok = success<UserId, MathErrc, Policy::Compact>(UserId{42});
+  REQUIRE(ok.has_value());
+  CHECK(*ok == UserId{42});
+
+  Result failed = std::unexpected(MathErrc::DivideByZero);
+  REQUIRE_FALSE(failed.has_value());
+  CHECK(failed.error() == MathErrc::DivideByZero);
+  CHECK(std::bit_cast<std::uint32_t>(failed) == 0xffffff00);
+
+  // Propagation and conversion from Policy::Dynamic
+  auto propagate = [](Result result) -> Result {
+    EXPECTION_TRY_ASSIGN(auto id, result);
+    return UserId{static_cast<std::uint32_t>(id) + 1};
+  };
+  CHECK(*propagate(ok) == UserId{43});
+  CHECK(propagate(failed).error() == MathErrc::DivideByZero);
+
+  auto resolved = resolve<Policy::Compact>(
+      std::expected<int *, ErrorCode<MathErrc>>(std::unexpect,
+                                                MathErrc::Overflow));
+  static_assert(sizeof(resolved) == sizeof(int *));
+  CHECK(resolved.error().kind == MathErrc::Overflow);
+}
+
+// === Compile-time evaluation ===
+
+template <Policy P>
+constexpr auto checked_reciprocal(int value) -> ResultType<int, MathErrc, P> {
+  if (value == 0) {
+    return std::unexpected(MathErrc::DivideByZero);
+  }
+  return success<int, MathErrc, P>(1000 / value);
+}
+
+// Failures are constant expressions under the policies returning them
+static_assert(!divide_by<FailureMethod::InPlace, Policy::Expected>(1, 0));
+static_assert(!divide_by<FailureMethod::Callable, Policy::Expected>(1, 0));
+static_assert(!divide_by<FailureMethod::Conversion, Policy::Compact>(1, 0));
+static_assert(detail::error_message<DivideByError>(
+                  DivideByError::Kind::DivideByZero) ==
+              std::string_view("Division by Zero"));
+static_assert(detail::error_message<MathErrc>(MathErrc::Overflow) ==
+              std::string_view("Overflow"));
+
+TEST_CASE("lookup tables computed at compile time") {
+  constexpr auto halves = [] consteval {
+    std::array<double, 4> table{};
+    for (int i = 0; i < 4; ++i) {
+      table[static_cast<std::size_t>(i)] = value_or_compile_error(
+          divide_by<FailureMethod::InPlace, Policy::Expected>(i, 2));
+    }
+    return table;
+  }();
+  static_assert(halves[3] == 1.5);
+  CHECK(halves[1] == doctest::Approx(0.5));
+
+  constexpr auto reciprocal = value_or_compile_error<[] {
+    return checked_reciprocal<Policy::Compact>(8);
+  }>();
+  static_assert(reciprocal == 125);
+
+  // Under the throwing policy the same function is usable when it succeeds
+  constexpr auto quarter =
+      value_or_compile_error(divide_by<FailureMethod::InPlace,
+                                       Policy::Exceptions>(1, 4));
+  static_assert(quarter == 0.25);
+  CHECK(quarter == doctest::Approx(0.25));
+}
+
+// === Error transport ===
+
+TEST_CASE("results cross threads through promises") {
+  auto produce = [](int denominator) {
+    std::promise<double> promise;
+    auto future = promise.get_future();
+    std::thread worker([&promise, denominator] {
+      set_result(promise, divide_by<FailureMethod::InPlace, Policy::Expected>(
+                              1, denominator));
+    });
+    worker.join();
+    return future;
+  };
+
+  SUBCASE("Exceptions consumer") {
+    auto ok = produce(2);
+    CHECK(ok.get() == doctest::Approx(0.5));
+
+    auto failed = produce(0);
+    bool thrown = false;
+    try {
+      failed.get();
+    } catch (const std::runtime_error &e) {
+      thrown = std::string(e.what()) == "Division by Zero";
+    }
+    CHECK(thrown);
+  }
+
+  SUBCASE("Expected consumer") {
+    auto ok = produce(4);
+    auto value = get_result<Policy::Expected>(ok);
+    REQUIRE(value.has_value());
+    CHECK(*value == doctest::Approx(0.25));
+
+    auto failed = produce(0);
+    auto error = get_result<Policy::Expected>(failed);
+    REQUIRE_FALSE(error.has_value());
+    CHECK_THROWS_AS(std::rethrow_exception(error.error()), std::runtime_error);
+  }
+
+  SUBCASE("void results") {
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    set_result(promise, client_check<Policy::Expected>(0));
+    CHECK_FALSE(get_result<Policy::Expected>(future).has_value());
+  }
+}
+
+TEST_CASE("results convert to and from exception_ptr") {
+  auto ok = divide_by<FailureMethod::InPlace, Policy::Expected>(1, 2);
+  CHECK(to_exception_ptr(ok) == nullptr);
+
+  auto failed = divide_by<FailureMethod::InPlace, Policy::Expected>(1, 0);
+  auto exception = to_exception_ptr(failed);
+  REQUIRE(exception != nullptr);
+
+  auto expected = from_exception_ptr<int, Policy::Expected>(exception);
+  REQUIRE_FALSE(expected.has_value());
+  CHECK(expected.error() == exception);
+  CHECK(to_exception_ptr(expected) == exception);
+
+  auto rethrow = [&] {
+    return from_exception_ptr<int, Policy::Exceptions>(exception);
+  };
+  CHECK_THROWS_AS(rethrow(), std::runtime_error);
+}
+
+// === Parallel algorithms ===
+
+TEST_CASE_TEMPLATE("parallel algorithms over fallible functions", P,
+                   std::integral_constant<Policy, Policy::Expected>,
+                   std::integral_constant<Policy, Policy::Exceptions>) {
+  constexpr auto Pol = P::value;
+  std::vector<int> denominators(1000);
+  for (std::size_t i = 0; i < denominators.size(); ++i) {
+    denominators[i] = static_cast<int>(i % 7) + 1;
+  }
+  auto divide = [](int denominator) {
+    return divide_by<FailureMethod::InPlace, Pol>(420, denominator);
+  };
+
+  auto unwrap = [](auto &&result) {
+    if constexpr (Pol == Policy::Expected) {
+      REQUIRE(result.has_value());
+      return *result;
+    } else {
+      return result;
+    }
+  };
+
+  std::vector<double> quotients(denominators.size());
+  auto transformed = [&] {
+    return parallel::transform<DivideByError, Pol>(denominators, quotients,
+                                                   divide, 4);
+  };
+  if constexpr (Pol == Policy::Expected) {
+    CHECK(transformed().has_value());
+  } else {
+    transformed();
+  }
+  CHECK(quotients[6] == doctest::Approx(60.0));
+
+  auto sum = parallel::transform_reduce<DivideByError, Pol>(
+      denominators, 0.0, std::plus<>{}, divide, 4);
+  CHECK(unwrap(sum) == doctest::Approx(std::accumulate(
+                           quotients.begin(), quotients.end(), 0.0)));
+
+  std::atomic<int> visited{0};
+  auto visit = [&](int) {
+    visited.fetch_add(1, std::memory_order_relaxed);
+    return success<DivideByError, Pol>();
+  };
+  auto each = [&] {
+    return parallel::for_each<DivideByError, Pol>(denominators, visit, 3);
+  };
+  if constexpr (Pol == Policy::Expected) {
+    CHECK(each().has_value());
+  } else {
+    each();
+  }
+  CHECK(visited == 1000);
+
+  // The first failure is propagated according to the policy
+  denominators[500] = 0;
+  auto failing = [&] {
+    return parallel::transform_reduce<DivideByError, Pol>(
+        denominators, 0.0, std::plus<>{}, divide, 4);
+  };
+  if constexpr (Pol == Policy::Expected) {
+    auto result = failing();
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().kind == DivideByError::Kind::DivideByZero);
+  } else {
+    CHECK_THROWS_AS(failing(), std::runtime_error);
+  }
+}
+
+TEST_CASE("parallel algorithms accumulate failures in element order") {
+  using IndexedError = ErrorCode<MathErrc, std::uint32_t>;
+  std::vector<std::uint32_t> indices(1000);
+  std::iota(indices.begin(), indices.end(), 0u);
+  auto check = [](std::uint32_t index)
+      -> ResultType<int, IndexedError, Policy::Accumulate> {
+    if (index % 150 == 7) {
+      return make_failure<int, IndexedError, Policy::Accumulate>(
+          MathErrc::Overflow, index);
+    }
+    return success<int, IndexedError, Policy::Accumulate>(1);
+  };
+
+  // Every chunk runs to its end, and its failures reach this thread's list
+  ErrorList<IndexedError> errors;
+  std::vector<int> out(indices.size());
+  parallel::transform<IndexedError, Policy::Accumulate>(indices, out, check,
+                                                        4);
+  REQUIRE(errors.size() == 7);
+  for (std::size_t i = 0; i < errors.size(); ++i) {
+    CHECK(errors[i].payload == 150 * i + 7);
+  }
+  CHECK(out[999] == 1);
+}
+
+TEST_CASE("parallel algorithms stop after the first failure") {
+  std::vector<int> denominators(1000, 1);
+  denominators[10] = 0;
+
+  int calls = 0;
+  auto result = parallel::for_each<DivideByError, Policy::Expected>(
+      denominators,
+      [&](int denominator) {
+        ++calls;
+        return check_nonzero<Policy::Expected>(denominator);
+      },
+      1);
+  CHECK_FALSE(result.has_value());
+  CHECK(calls == 11);
+}
+
+TEST_CASE("parallel algorithms rethrow foreign exceptions under every policy") {
+  std::vector<int> values(1000, 1);
+  values[700] = 0;
+
+  auto visit =
+      [](int value) -> ResultType<void, DivideByError, Policy::Expected> {
+    if (value == 0) {
+      throw std::logic_error("foreign");
+    }
+    return success<DivideByError, Policy::Expected>();
+  };
+  CHECK_THROWS_WITH_AS(
+      (parallel::for_each<DivideByError, Policy::Expected>(values, visit, 4)),
+      "foreign", std::logic_error);
+}
+
+// === Error accumulation ===
+
+TEST_CASE_TEMPLATE(
+    "Accumulate policy collects every failure", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  constexpr auto FailMethod = F::value;
+  const int denominators[] = {1, 0, 2, 0, 0, 4};
+
+  // Up to Inline errors are stored in the list itself: nothing is allocated
+  ErrorList<DivideByError, 4> errors(std::pmr::null_memory_resource());
+  CHECK(errors.empty());
+
+  double sum = 0;
+  int poisoned_results = 0;
+  for (int denominator : denominators) {
+    const double quotient =
+        divide_by<FailMethod, Policy::Accumulate>(4, denominator);
+    if (std::isnan(quotient)) {
+      ++poisoned_results;
+    } else {
+      sum += quotient;
+    }
+  }
+
+  CHECK(sum == doctest::Approx(4 + 2 + 1));
+  CHECK(poisoned_results == 3);
+  REQUIRE(errors.size() == 3);
+  for (const auto &error : errors) {
+    CHECK(error.kind == DivideByError::Kind::DivideByZero);
+  }
+}
+
+TEST_CASE("ErrorList grows past its inline storage and nests") {
+  std::pmr::monotonic_buffer_resource arena;
+  ErrorList<ErrorCode<MathErrc>, 2> outer(&arena);
+
+  auto fail = [](MathErrc kind) {
+    return make_failure<int, ErrorCode<MathErrc>, Policy::Accumulate>(kind);
+  };
+  CHECK(fail(MathErrc::Overflow) == 0);
+
+  {
+    ErrorList<ErrorCode<MathErrc>> inner;
+    (void)fail(MathErrc::DivideByZero);
+    REQUIRE(inner.size() == 1);
+    CHECK(inner[0].kind == MathErrc::DivideByZero);
+  }
+
+  for (int i = 0; i < 5; ++i) {
+    (void)fail(MathErrc::DivideByZero);
+  }
+  REQUIRE(outer.size() == 6);
+  CHECK(outer[0].kind == MathErrc::Overflow);
+  CHECK(outer[5].kind == MathErrc::DivideByZero);
+}
+
+TEST_CASE("Accumulate policy without an ErrorList calls the abort handler") {
+  bool handler_called = false;
+  try {
+    (void)make_failure<int, ErrorCode<MathErrc>, Policy::Accumulate>(
+        MathErrc::Overflow);
+  } catch (const AbortCalled &) {
+    handler_called = true;
+  }
+  CHECK(handler_called);
+}
+
+TEST_CASE("transform_batch with Accumulate policy") {
+  std::vector<int> denominators = {1, 0, 4, 0};
+  std::vector<double> out(denominators.size());
+  ErrorList<ErrorCode<MathErrc>> errors;
+
+  auto result = transform_batch<double, ErrorCode<MathErrc>, Policy::Accumulate>(
+      std::span<double>(out),
+      [](double &value, int denominator) {
+        value = 4.0 / denominator;
+        return denominator != 0;
+      },
+      [](int) { return ErrorCode<MathErrc>(MathErrc::DivideByZero); },
+      denominators);
+
+  CHECK(result.size() == 4);
+  CHECK(out[2] == doctest::Approx(1.0));
+  CHECK(std::isnan(out[1]));
+  CHECK(std::isnan(out[3]));
+  CHECK(errors.size() == 2);
+}
+
+// === Allocator-aware errors ===
+
+struct RecordError {
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  std::pmr::string path;
+
+  RecordError(std::string_view path, allocator_type alloc = {})
+      : path(path, alloc) {}
+  RecordError(const RecordError &other, allocator_type alloc)
+      : path(other.path, alloc) {}
+  RecordError(RecordError &&other, allocator_type alloc)
+      : path(std::move(other.path), alloc) {}
+  RecordError(const RecordError &) = default;
+  RecordError(RecordError &&) = default;
+
+  auto exception() const {
+    return std::runtime_error("invalid record " + std::string(path));
+  }
+};
+
+static_assert(std::uses_allocator_v<RecordError, RecordError::allocator_type>);
+
+template <Policy P>
+auto load_record(std::pmr::memory_resource *arena, std::string_view path)
+    -> ResultType<int, RecordError, P> {
+  return make_failure_alloc<int, RecordError, P>(
+      std::pmr::polymorphic_allocator<>(arena), path);
+}
+
+TEST_CASE("errors constructed in an arena") {
+  // Every allocation must come from the buffer
+  std::byte buffer[1024];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                            std::pmr::null_memory_resource());
+  const std::string_view path = "/var/lib/records/0000000042.json";
+
+  SUBCASE("make_failure_alloc") {
+    auto result = load_record<Policy::Expected>(&arena, path);
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().path == path);
+    CHECK(result.error().path.get_allocator().resource() == &arena);
+  }
+
+  SUBCASE("failure_alloc") {
+    RecordError error(path);
+    auto result = failure_alloc<int, Policy::Expected>(
+        std::pmr::polymorphic_allocator<>(&arena), error);
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().path.get_allocator().resource() == &arena);
+  }
+
+  SUBCASE("Accumulate") {
+    ErrorList<RecordError> errors(&arena);
+    CHECK(load_record<Policy::Accumulate>(&arena, path) == 0);
+    REQUIRE(errors.size() == 1);
+    CHECK(errors[0].path == path);
+  }
+
+  SUBCASE("Exceptions") {
+    CHECK_THROWS_AS(load_record<Policy::Exceptions>(&arena, path),
+                    std::runtime_error);
+  }
+}
+
+TEST_CASE_TEMPLATE("policy-generic accessors", P,
+                   std::integral_constant<Policy, Policy::Exceptions>,
+                   std::integral_constant<Policy, Policy::Expected>,
+                   std::integral_constant<Policy, Policy::Compact>) {
+  constexpr auto policy = P::value;
+
+  CHECK(unwrap<policy>(divide_by<FailureMethod::InPlace, policy>(1, 2)) ==
+        doctest::Approx(0.5));
+  CHECK(unwrap_unchecked<policy>(
+            divide_by<FailureMethod::InPlace, policy>(1, 4)) ==
+        doctest::Approx(0.25));
+  CHECK(value_or<policy>(divide_by<FailureMethod::InPlace, policy>(1, 2),
+                         -1.0) == doctest::Approx(0.5));
+
+  // Lvalues give references to the value
+  auto result = divide_by<FailureMethod::InPlace, policy>(3, 4);
+  CHECK(&unwrap<policy>(result) == &unwrap_unchecked<policy>(result));
+
+  if constexpr (ReturnsExpected<policy>) {
+    CHECK(value_or<policy>(divide_by<FailureMethod::InPlace, policy>(1, 0),
+                           -1.0) == -1.0);
+    bool handler_called = false;
+    try {
+      (void)unwrap<policy>(divide_by<FailureMethod::InPlace, policy>(1, 0));
+    } catch (const AbortCalled &) {
+      handler_called = true;
+    }
+    CHECK(handler_called);
+
+    unwrap<policy>(success<DivideByError, policy>());
+  }
+}
+
+// Lightweight exceptions
+
+struct LightDivideByError {
+  enum class Kind { DivideByZero, Overflow };
+
+  Kind kind;
+  int numerator;
+
+  static constexpr char const *err_to_str(Kind kind) {
+    return kind == Kind::DivideByZero ? "Division by Zero" : "Overflow";
+  }
+
+  static auto exception(Kind kind, int numerator) {
+    return light_exception(LightDivideByError{kind, numerator});
+  }
+
+  auto exception() const { return light_exception(*this); }
+};
+
+static_assert(sizeof(light_exception<LightDivideByError>) ==
+              sizeof(std::exception) + sizeof(LightDivideByError));
+static_assert(std::is_nothrow_copy_constructible_v<
+              light_exception<ErrorCode<MathErrc>>>);
+
+template <FailureMethod F, Policy P>
+auto light_divide(int numerator, int denominator)
+    -> ResultType<int, LightDivideByError, P> {
+  using Error = LightDivideByError;
+  if (denominator == 0) {
+    if constexpr (F == FailureMethod::InPlace) {
+      return make_failure<int, Error, P>(Error::Kind::DivideByZero,
+                                         numerator);
+    } else {
+      return failure<int, P>(Error{Error::Kind::DivideByZero, numerator});
+    }
+  }
+  return success<int, Error, P>(numerator / denominator);
+}
+
+TEST_CASE_TEMPLATE("light_exception carries the Error", F,
+                   std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+                   std::integral_constant<FailureMethod,
+                                          FailureMethod::Conversion>) {
+  constexpr auto P = Policy::Exceptions;
+  CHECK(light_divide<F::value, P>(6, 3) == 2);
+
+  bool caught = false;
+  try {
+    (void)light_divide<F::value, P>(7, 0);
+  } catch (const light_exception<LightDivideByError> &exception) {
+    caught = true;
+    CHECK(exception.error().kind == LightDivideByError::Kind::DivideByZero);
+    CHECK(exception.error().numerator == 7);
+    CHECK(std::string_view(exception.what()) == "Division by Zero");
+  }
+  CHECK(caught);
+
+  // Caught as any std::exception
+  auto fail = [] { return light_divide<F::value, P>(1, 0); };
+  CHECK_THROWS_WITH_AS(fail(), "Division by Zero", std::exception);
+}
+
+TEST_CASE("light_exception of an ErrorCode") {
+  const light_exception exception(
+      ErrorCode<MathErrc, std::uint32_t>(MathErrc::Overflow, 12u));
+  CHECK(std::string_view(exception.what()) == "Overflow");
+  CHECK(exception.error().payload == 12);
+}
+
+// Coroutine tasks
+
+template <Policy P>
+auto divide_task(int numerator, int denominator)
+    -> Task<double, DivideByError, P> {
+  co_return divide_by<FailureMethod::InPlace, P>(numerator, denominator);
+}
+
+template <Policy P>
+auto sum_of_quotients(int denominator) -> Task<double, DivideByError, P> {
+  EXPECTION_CO_TRY_ASSIGN(auto half, co_await divide_task<P>(1, 2));
+  EXPECTION_CO_TRY_ASSIGN(auto quotient,
+                          co_await divide_task<P>(1, denominator));
+  co_return success<double, DivideByError, P>(half + quotient);
+}
+
+// Counts the frames allocated through it
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocations = 0;
+  std::size_t live = 0;
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment)
+      -> void * override {
+    ++allocations;
+    ++live;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    --live;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  auto do_is_equal(const std::pmr::memory_resource &other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+};
+
+// The frame comes from the allocator_arg operator new, and is freed by the
+// usual operator delete, which finds the resource in the frame's footer
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+template <Policy P>
+auto pooled_task(std::allocator_arg_t, std::pmr::memory_resource *,
+                 int denominator) -> Task<double, DivideByError, P> {
+  co_return divide_by<FailureMethod::InPlace, P>(1, denominator);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+TEST_CASE("coroutine tasks under Policy::Expected") {
+  constexpr auto P = Policy::Expected;
+
+  auto result = sync_wait(sum_of_quotients<P>(4));
+  REQUIRE(result.has_value());
+  CHECK(*result == doctest::Approx(0.75));
+
+  auto failed = sync_wait(sum_of_quotients<P>(0));
+  REQUIRE_FALSE(failed.has_value());
+  CHECK(failed.error().kind == DivideByError::Kind::DivideByZero);
+}
+
+TEST_CASE("coroutine tasks under Policy::Exceptions") {
+  constexpr auto P = Policy::Exceptions;
+
+  CHECK(sync_wait(sum_of_quotients<P>(4)) == doctest::Approx(0.75));
+  CHECK_THROWS_AS(sync_wait(sum_of_quotients<P>(0)), std::runtime_error);
+
+  auto nothing = []() -> Task<void, DivideByError, P> { co_return; };
+  sync_wait(nothing());
+}
+
+TEST_CASE("coroutine task frames come from the given resource") {
+  CountingResource resource;
+
+  SUBCASE("allocator_arg") {
+    auto succeeded = sync_wait(
+        pooled_task<Policy::Expected>(std::allocator_arg, &resource, 2));
+    CHECK(succeeded.has_value());
+    auto failed = sync_wait(
+        pooled_task<Policy::Expected>(std::allocator_arg, &resource, 0));
+    CHECK_FALSE(failed.has_value());
+    // One frame per task, whatever the outcome
+    CHECK(resource.allocations == 2);
+  }
+
+  SUBCASE("set_task_frame_resource") {
+    auto *previous = set_task_frame_resource(&resource);
+    auto result = sync_wait(sum_of_quotients<Policy::Expected>(0));
+    set_task_frame_resource(previous);
+    CHECK_FALSE(result.has_value());
+    CHECK(resource.allocations == 3);
+  }
+
+  CHECK(resource.live == 0);
+}
+
+TEST_CASE("taking the outcome of an unfinished task aborts") {
+  detail::TaskPromise<double, DivideByError, Policy::Expected> promise;
+  CHECK_THROWS_AS(promise.take(), AbortCalled);
+}
+
+// Error maps
+
+enum class StorageErrc { NotFound, Corrupted, Full };
+enum class ServiceErrc { InvalidArgument, Unavailable };
+
+constexpr auto service_errors = make_error_map<ServiceErrc>({
+    {ServiceErrc::InvalidArgument, "Invalid argument"},
+    {ServiceErrc::Unavailable, "Service unavailable"},
+});
+
+constexpr auto err_to_str(ServiceErrc kind) -> const char * {
+  return service_errors.message(kind);
+}
+
+// Listed out of order, placed by enumerator
+constexpr auto storage_errors = make_error_map<StorageErrc, ServiceErrc>({
+    {StorageErrc::Full, "Storage full", ServiceErrc::Unavailable,
+     exception_as<std::overflow_error>},
+    {StorageErrc::NotFound, "Block not found", ServiceErrc::InvalidArgument,
+     exception_as<std::out_of_range>},
+    {StorageErrc::Corrupted, "Block corrupted", ServiceErrc::Unavailable},
+});
+
+using StorageError = MappedError<storage_errors>;
+
+static_assert(std::string_view(StorageError::err_to_str(StorageErrc::Full)) ==
+              "Storage full");
+static_assert(storage_errors.translate(StorageErrc::NotFound) ==
+              ServiceErrc::InvalidArgument);
+
+template <Policy P>
+auto read_block(int block) -> ResultType<int, StorageError, P> {
+  if (block < 0) {
+    return make_failure<int, StorageError, P>(StorageErrc::NotFound);
+  }
+  if (block > 100) {
+    return failure<int, P>(StorageError{StorageErrc::Full});
+  }
+  if (block == 13) {
+    return make_failure<int, StorageError, P>(StorageErrc::Corrupted);
+  }
+  return success<int, StorageError, P>(block * 2);
+}
+
+TEST_CASE("mapped errors throw the exception type of their kind") {
+  constexpr auto P = Policy::Exceptions;
+  CHECK(read_block<P>(4) == 8);
+  CHECK_THROWS_AS(read_block<P>(-1), std::out_of_range);
+  CHECK_THROWS_AS(read_block<P>(200), std::overflow_error);
+  CHECK_THROWS_WITH_AS(read_block<P>(13), "Block corrupted",
+                       std::runtime_error);
+}
+
+TEST_CASE("mapped errors outside the map call the abort handler") {
+  const auto outside = static_cast<StorageErrc>(3);
+  CHECK_THROWS_AS(StorageError::exception_ptr(outside), AbortCalled);
+  auto fail = [&] {
+    return failure<int, Policy::Exceptions>(StorageError{outside});
+  };
+  CHECK_THROWS_AS(fail(), AbortCalled);
+}
+
+TEST_CASE("mapped errors translate at layer boundaries") {
+  using ServiceError = ErrorCode<ServiceErrc>;
+
+  auto translated = translate<ServiceError, Policy::Expected>(
+      storage_errors, read_block<Policy::Expected>(200));
+  REQUIRE_FALSE(translated.has_value());
+  CHECK(translated.error().kind == ServiceErrc::Unavailable);
+  CHECK(std::string_view(translated.error().str()) == "Service unavailable");
+
+  auto passed = translate<ServiceError, Policy::Compact>(
+      storage_errors, read_block<Policy::Compact>(21));
+  REQUIRE(passed.has_value());
+  CHECK(*passed == 42);
+
+  // Throwing policies pass the value through
+  CHECK(translate<ServiceError, Policy::Exceptions>(
+            storage_errors, read_block<Policy::Exceptions>(3)) == 6);
+}
+
+TEST_CASE("to_exception_ptr converts as failure() throws") {
+  // Prebuilt: the same exception is handed out on every conversion
+  auto prebuilt = to_exception_ptr(StorageError{StorageErrc::NotFound});
+  CHECK(prebuilt == StorageError::exception_ptr(StorageErrc::NotFound));
+  CHECK_THROWS_AS(std::rethrow_exception(prebuilt), std::out_of_range);
+
+  // Kind-keyed: built from the static exception(kind)
+  auto from_kind = to_exception_ptr(KindOnlyError{KindOnlyError::Kind::Busy});
+  CHECK_THROWS_WITH_AS(std::rethrow_exception(from_kind), "Busy",
+                       std::runtime_error);
+
+  auto failed = library_acquire(true);
+  CHECK_THROWS_WITH_AS(std::rethrow_exception(to_exception_ptr(failed)),
+                       "Busy", std::runtime_error);
+}
+
+// Boundary adapters
+
+// Inner layers under Policy::Boundary, and their edge under Exceptions
+auto boundary_inner(int numerator, int denominator)
+    -> ResultType<double, DivideByError, Policy::Boundary> {
+  EXPECTION_TRY_ASSIGN(auto half,
+                       divide_by<FailureMethod::InPlace, Policy::Boundary>(
+                           numerator, 2));
+  EXPECTION_TRY_ASSIGN(auto quotient,
+                       divide_by<FailureMethod::Conversion, Policy::Boundary>(
+                           numerator, denominator));
+  return success<double, DivideByError, Policy::Boundary>(half + quotient);
+}
+
+auto boundary_quotient(int numerator, int denominator) -> double {
+  return throw_if_error(boundary_inner(numerator, denominator));
+}
+
+TEST_CASE("throw_if_error converts at the boundary") {
+  CHECK(boundary_quotient(4, 4) == doctest::Approx(3.0));
+  CHECK_THROWS_AS(boundary_quotient(1, 0), std::runtime_error);
+
+  auto result = divide_by<FailureMethod::InPlace, Policy::Boundary>(1, 4);
+  CHECK(&throw_if_error(result) == &*result);
+
+  std::expected<int, std::exception_ptr> foreign(
+      std::unexpect, std::make_exception_ptr(std::out_of_range("foreign")));
+  CHECK_THROWS_AS(throw_if_error(foreign), std::out_of_range);
+
+  throw_if_error(success<DivideByError, Policy::Boundary>());
+}
+
+TEST_CASE("catch_to_expected converts throwing calls") {
+  SUBCASE("light_exception") {
+    auto result = catch_to_expected<LightDivideByError>(
+        light_divide<FailureMethod::InPlace, Policy::Exceptions>, 5, 0);
+    REQUIRE_FALSE(result.has_value());
+    CHECK(result.error().numerator == 5);
+
+    auto succeeded = catch_to_expected<LightDivideByError>(
+        light_divide<FailureMethod::InPlace, Policy::Exceptions>, 6, 2);
+    REQUIRE(succeeded.has_value());
+    CHECK(*succeeded == 3);
+  }
+
+  SUBCASE("exception_ptr") {
+    auto result = catch_to_expected(
+        divide_by<FailureMethod::InPlace, Policy::Exceptions>, 1, 0);
+    REQUIRE_FALSE(result.has_value());
+    CHECK_THROWS_AS(std::rethrow_exception(result.error()), std::runtime_error);
+
+    auto nothing = catch_to_expected([] {});
+    CHECK(nothing.has_value());
+  }
+
+  SUBCASE("other exceptions propagate") {
+    auto call = [] {
+      return catch_to_expected<LightDivideByError>(
+          divide_by<FailureMethod::InPlace, Policy::Exceptions>, 1, 0);
+    };
+    CHECK_THROWS_AS(call(), std::runtime_error);
+  }
+}
+
+// Circuit breakers
+
+// Every breaker test uses its own Error type, and so its own breaker
+template <int Id> struct RemoteError {
+  enum class Kind { Timeout, CircuitOpen };
+
+  Kind kind;
+
+  static constexpr auto err_to_str(Kind kind) -> const char * {
+    return kind == Kind::Timeout ? "Timeout" : "Circuit open";
+  }
+
+  static auto exception(Kind kind) {
+    return std::runtime_error(err_to_str(kind));
+  }
+
+  auto exception() const { return std::runtime_error(err_to_str(kind)); }
+};
+
+template <int Id, Policy P>
+auto remote_call(bool fail, std::atomic<int> &runs)
+    -> ResultType<int, RemoteError<Id>, P> {
+  ++runs;
+  if (fail) {
+    return make_failure<int, RemoteError<Id>, P>(
+        RemoteError<Id>::Kind::Timeout);
+  }
+  return success<int, RemoteError<Id>, P>(1);
+}
+
+constexpr auto test_breaker = breaker::Config{
+    .failure_ratio = 0.5,
+    .minimum_calls = 8,
+    .window = std::chrono::hours(1),
+    .cooldown = std::chrono::milliseconds(20),
+};
+
+template <int Id, Policy P>
+auto guarded_remote_call(bool fail, std::atomic<int> &runs) {
+  return breaker::call<RemoteError<Id>, P>(
+      [&] { return remote_call<Id, P>(fail, runs); });
+}
+
+TEST_CASE("circuit breakers short-circuit returned errors") {
+  constexpr auto P = Policy::Expected;
+  using Error = RemoteError<0>;
+  breaker::configure(test_breaker, Error{Error::Kind::CircuitOpen});
+  std::atomic<int> runs = 0;
+
+  for (int i = 0; i < 4; ++i) {
+    CHECK(guarded_remote_call<0, P>(false, runs).has_value());
+  }
+  for (int i = 0; i < 3; ++i) {
+    CHECK_FALSE(guarded_remote_call<0, P>(true, runs).has_value());
+  }
+  CHECK(breaker::state<Error>() == breaker::State::Closed);
+
+  // 4 failures in 8 calls
+  CHECK_FALSE(guarded_remote_call<0, P>(true, runs).has_value());
+  CHECK(breaker::state<Error>() == breaker::State::Open);
+
+  auto short_circuited = guarded_remote_call<0, P>(false, runs);
+  REQUIRE_FALSE(short_circuited.has_value());
+  CHECK(short_circuited.error().kind == Error::Kind::CircuitOpen);
+  CHECK(runs == 8);
+  CHECK(breaker::short_circuits<Error>() == 1);
+
+  SUBCASE("a successful trial closes the breaker") {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(guarded_remote_call<0, P>(false, runs).has_value());
+    CHECK(runs == 9);
+    CHECK(breaker::state<Error>() == breaker::State::Closed);
+  }
+
+  SUBCASE("a failed trial opens it again") {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK_FALSE(guarded_remote_call<0, P>(true, runs).has_value());
+    CHECK(breaker::state<Error>() == breaker::State::Open);
+    CHECK_FALSE(guarded_remote_call<0, P>(false, runs).has_value());
+    CHECK(runs == 9);
+  }
+}
+
+TEST_CASE("circuit breakers rethrow a prebuilt exception") {
+  constexpr auto P = Policy::Exceptions;
+  using Error = RemoteError<1>;
+  breaker::configure(test_breaker, Error{Error::Kind::CircuitOpen});
+  std::atomic<int> runs = 0;
+  auto remote = [&](bool fail) {
+    return guarded_remote_call<1, P>(fail, runs);
+  };
+
+  for (int i = 0; i < 8; ++i) {
+    CHECK_THROWS_WITH_AS(remote(true), "Timeout",
+                         std::runtime_error);
+  }
+  CHECK(breaker::state<Error>() == breaker::State::Open);
+  CHECK_THROWS_WITH_AS(remote(false), "Circuit open",
+                       std::runtime_error);
+  CHECK(runs == 8);
+
+  // The trial throws, and reopens the breaker
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  CHECK_THROWS_WITH_AS(remote(true), "Timeout",
+                       std::runtime_error);
+  CHECK(breaker::state<Error>() == breaker::State::Open);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  CHECK(remote(false) == 1);
+  CHECK(breaker::state<Error>() == breaker::State::Closed);
+}
+
+// Without a conversion: the open exception comes from exception(kind)
+struct KindOnlyRemoteError {
+  enum class Kind { Timeout, CircuitOpen };
+
+  Kind kind;
+
+  static auto exception(Kind kind) {
+    return std::runtime_error(kind == Kind::Timeout ? "Timeout"
+                                                    : "Circuit open");
+  }
+};
+
+TEST_CASE("circuit breakers throw the exception of an Error's kind") {
+  constexpr auto P = Policy::Exceptions;
+  using Error = KindOnlyRemoteError;
+  breaker::configure(test_breaker, Error{Error::Kind::CircuitOpen});
+  auto remote = [](bool fail) {
+    return breaker::call<Error, P>([fail] {
+      if (fail) {
+        return make_failure<int, Error, P>(Error::Kind::Timeout);
+      }
+      return success<int, Error, P>(1);
+    });
+  };
+
+  for (int i = 0; i < 8; ++i) {
+    CHECK_THROWS_WITH_AS(remote(true), "Timeout", std::runtime_error);
+  }
+  CHECK(breaker::state<Error>() == breaker::State::Open);
+  CHECK_THROWS_WITH_AS(remote(false), "Circuit open", std::runtime_error);
+}
+
+TEST_CASE("circuit breakers stay closed until configured") {
+  using Error = RemoteError<2>;
+  std::atomic<int> runs = 0;
+  for (int i = 0; i < 100; ++i) {
+    auto result = guarded_remote_call<2, Policy::Expected>(true, runs);
+    CHECK_FALSE(result.has_value());
+  }
+  CHECK(breaker::state<Error>() == breaker::State::Closed);
+  CHECK(runs == 100);
+}
+
+TEST_CASE("circuit breakers only count failures inside breaker::call") {
+  constexpr auto P = Policy::Expected;
+  using Error = RemoteError<4>;
+  breaker::configure(test_breaker, Error{Error::Kind::CircuitOpen});
+  std::atomic<int> runs = 0;
+
+  for (int i = 0; i < 20; ++i) {
+    CHECK_FALSE(remote_call<4, P>(true, runs).has_value());
+  }
+  // 3 failures in 8 calls
+  for (int i = 0; i < 5; ++i) {
+    CHECK(guarded_remote_call<4, P>(false, runs).has_value());
+  }
+  for (int i = 0; i < 3; ++i) {
+    CHECK_FALSE(guarded_remote_call<4, P>(true, runs).has_value());
+  }
+  CHECK(breaker::state<Error>() == breaker::State::Closed);
+}
+
+TEST_CASE("circuit breakers count calls from every thread") {
+  constexpr auto P = Policy::Expected;
+  using Error = RemoteError<3>;
+  breaker::configure(test_breaker, Error{Error::Kind::CircuitOpen});
+  std::atomic<int> runs = 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 1000; ++i) {
+        (void)guarded_remote_call<3, P>(i % 4 != 0, runs);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Trials may have closed the breaker since
+  CHECK(breaker::short_circuits<Error>() > 0);
+  CHECK(runs + breaker::short_circuits<Error>() == 4000);
+}
+
+// Policy equivalence
+
+template <Policy P>
+auto policy_dependent(int x) -> ResultType<int, DivideByError, P> {
+  if (x < 0) {
+    return make_failure<int, DivideByError, P>(
+        DivideByError::Kind::DivideByZero);
+  }
+  return success<int, DivideByError, P>(P == Policy::Exceptions ? x : x + 1);
+}
+
+TEST_CASE_TEMPLATE(
+    "policy_mismatch finds no difference between divide_by policies", F,
+    std::integral_constant<FailureMethod, FailureMethod::InPlace>,
+    std::integral_constant<FailureMethod, FailureMethod::Functor>,
+    std::integral_constant<FailureMethod, FailureMethod::Callable>,
+    std::integral_constant<FailureMethod, FailureMethod::Conversion>) {
+  auto divide = []<Policy P>(int a, int b) {
+    return divide_by<F::value, P>(a, b);
+  };
+  CHECK(policy_mismatch(divide, 1, 2) == nullptr);
+  CHECK(policy_mismatch(divide, 1, 0) == nullptr);
+  CHECK(policy_mismatch(divide, 0, 0) == nullptr);
+}
+
+TEST_CASE("policy_mismatch reports differences") {
+  auto dependent = []<Policy P>(int x) { return policy_dependent<P>(x); };
+  CHECK(std::string_view(policy_mismatch(dependent, 1)) ==
+        "Exceptions and Expected returned different values");
+  CHECK(policy_mismatch(dependent, -1) == nullptr);
+}
+
+// Failure-rate profiles
+
+static_assert(profile::function_key(
+                  "constexpr Expection::ResultType<int, ParseError, P> "
+                  "parse::record(std::string_view) [with Expection::Policy P "
+                  "= Expection::Policy::Expected]") == "parse::record");
+static_assert(profile::function_key(
+                  "auto (anonymous namespace)::record(int) [P = "
+                  "Expection::Policy::Expected]") ==
+              "(anonymous namespace)::record");
+static_assert(profile::function_key(
+                  "auto __cdecl parse::record<Expection::Policy::Expected>"
+                  "(int)") == "parse::record");
+static_assert(profile::function_key("main()::<lambda(int)>") == "main");
+
+// Selected by testexpection_policies.hpp
+template <Policy P = EXPECTION_POLICY_FOR(profiled_parse)>
+auto profiled_parse(int value) -> ResultType<int, DivideByError, P> {
+  if (value % 20 == 0) {
+    return failure<int, P>(DivideByError{DivideByError::Kind::DivideByZero});
+  }
+  return success<int, DivideByError, P>(value);
+}
+
+// profiled_lookup alone is ambiguous, with cache::profiled_lookup selected too
+namespace storage {
+template <Policy P = EXPECTION_POLICY_FOR(storage::profiled_lookup)>
+auto profiled_lookup(int key) -> ResultType<int, DivideByError, P> {
+  return success<int, DivideByError, P>(key);
+}
+} // namespace storage
+
+// make_failure(), make_failure_alloc() and success_in_place() attribute their
+// outcomes to their caller too
+namespace {
+template <Policy P = EXPECTION_POLICY_FOR(profiled_decode)>
+auto profiled_decode(int value) -> ResultType<int, DivideByError, P> {
+  if (value % 10 == 0) {
+    return make_failure<int, DivideByError, P>(
+        DivideByError::Kind::DivideByZero);
+  }
+  return success_in_place<int, DivideByError, P>(value);
+}
+
+auto profiled_load(std::string_view path)
+    -> ResultType<int, RecordError, Policy::Expected> {
+  return make_failure_alloc<int, RecordError, Policy::Expected>(
+      std::pmr::polymorphic_allocator<>(), path);
+}
+} // namespace
+
+static_assert(EXPECTION_POLICY_FOR(profiled_parse) == Policy::Expected);
+static_assert(EXPECTION_POLICY_FOR(profiled_decode) == Policy::Expected);
+static_assert(EXPECTION_POLICY_FOR(storage::profiled_lookup) ==
+              Policy::Exceptions);
+static_assert(EXPECTION_POLICY_FOR(cache::profiled_lookup) ==
+              Policy::Expected);
+static_assert(EXPECTION_POLICY_FOR(lookup) == DefaultPolicy);
+static_assert(EXPECTION_POLICY_FOR(divide_by) == DefaultPolicy);
+
+TEST_CASE("profiles count outcomes per function") {
+  for (int i = 0; i < 1000; ++i) {
+    (void)profiled_parse(i);
+    (void)profiled_decode(i);
+    CHECK(storage::profiled_lookup(i) == i);
+  }
+  for (int i = 0; i < 50; ++i) {
+    CHECK_FALSE(profiled_load("/var/lib/records").has_value());
+  }
+
+  std::uint64_t parse_successes = 0;
+  std::uint64_t parse_failures = 0;
+  std::uint64_t decode_successes = 0;
+  std::uint64_t decode_failures = 0;
+  std::uint64_t lookup_successes = 0;
+  std::uint64_t load_failures = 0;
+  profile::for_each_site([&](std::string_view function,
+                             std::uint64_t successes, std::uint64_t failures) {
+    if (function == "profiled_parse") {
+      parse_successes += successes;
+      parse_failures += failures;
+    } else if (function.ends_with("anonymous}::profiled_decode") ||
+               function == "(anonymous namespace)::profiled_decode") {
+      decode_successes += successes;
+      decode_failures += failures;
+    } else if (function == "storage::profiled_lookup") {
+      lookup_successes += successes;
+      CHECK(failures == 0);
+    } else if (function.ends_with("anonymous}::profiled_load") ||
+               function == "(anonymous namespace)::profiled_load") {
+      load_failures += failures;
+    }
+  });
+  CHECK(parse_successes == 950);
+  CHECK(parse_failures == 50);
+  CHECK(decode_successes == 900);
+  CHECK(decode_failures == 100);
+  CHECK(lookup_successes == 1000);
+  CHECK(load_failures == 50);
+}
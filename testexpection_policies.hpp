@@ -0,0 +1,6 @@
+// Policy selections of testexpection.cpp, in the format of the headers
+// generated by cmake/PolicyProfile.cmake
+EXPECTION_SELECT((anonymous namespace)::profiled_decode, Expected)
+EXPECTION_SELECT(profiled_parse, Expected)
+EXPECTION_SELECT(cache::profiled_lookup, Expected)
+EXPECTION_SELECT(storage::profiled_lookup, Exceptions)